@@ -16,6 +16,12 @@
 #include <algorithm>                              // Para std::transform, std::max_element
 #include <random>                                 // Para amostragem
 #include <unordered_map>                          // Para o mapa de perdas
+#include <utility>                                // Para std::as_const e std::move
+#include <cstring>                                // Para std::strcmp
+#include <cstdlib>                                // Para std::atoi
+#include <sstream>                                // Para std::istringstream
+#include <iterator>                               // Para std::istreambuf_iterator
+#include <filesystem>                             // Para std::filesystem::exists
 #include "./include/01RMTAEmbedding.hpp"           // Header para a classe de embeddings
 #include "./include/02RMTATokenizer.hpp"           // Header para a classe de tokenização
 #include "./include/03RMTAPositionalEncoding.hpp"  // Header para codificação posicional
@@ -25,9 +31,20 @@
 #include "./include/10RMTADecoder.hpp"             // Header para implementação do decoder
 #include "./include/FinalLayer.hpp"               // Header para a camada final de saída
 #include "./include/VectorOp.hpp"                 // Header para operações de vetores
+#include "./include/Tensor.hpp"                   // Header para o tipo Tensor (matriz contígua)
+#include "./include/CpuFeatures.hpp"              // Header para a detecção de extensões SIMD
+#include "./include/Checkpoint.hpp"               // Header para o checkpoint binário mapeado em memória
+#include "./include/DatasetCache.hpp"             // Header para o dataset tokenizado mapeado em memória
+#include "./include/DatasetStream.hpp"            // Header para a leitura do dataset em segundo plano
+#include "./include/BatchLayout.hpp"              // Header para lotes de sequências com padding
+#include "./include/BatchScheduler.hpp"           // Header para o agrupamento dos exemplos em lotes por comprimento
+#include "./include/ThreadPool.hpp"               // Header para o pool de threads compartilhado pelo processo
+#include "./include/LayerPipeline.hpp"            // Header para a execução das camadas em pipeline
+#include "./include/ActivationArena.hpp"          // Header para a arena das ativações do forward pass
+#include <memory>                                 // Para std::unique_ptr
 
 // Função para calcular a perda de cross-entropy com base nas probabilidades previstas e o token alvo
-double computeCrossEntropyLoss(const std::vector<double> &predictedProbabilities, int targetTokenID)
+double computeCrossEntropyLoss(std::span<const real_t> predictedProbabilities, int targetTokenID)
 {
     // Pegando a probabilidade prevista para o token alvo
     double predictedProbability = predictedProbabilities[targetTokenID];  
@@ -42,10 +59,10 @@ double computeCrossEntropyLoss(const std::vector<double> &predictedProbabilities
 }
 
 // Função para calcular o gradiente da perda em relação à saída da camada
-std::vector<double> computeGradientOfLossWrtLayerOutput(const std::vector<double>& predictions, const std::vector<double>& trueLabels) {
+std::vector<real_t> computeGradientOfLossWrtLayerOutput(std::span<const real_t> predictions, std::span<const real_t> trueLabels) {
 
     // Vetor para armazenar os gradientes
-    std::vector<double> gradients(predictions.size());  
+    std::vector<real_t> gradients(predictions.size());  
 
     // Calculando o gradiente para cada previsão
     for (size_t i = 0; i < predictions.size(); ++i) {
@@ -57,175 +74,616 @@ std::vector<double> computeGradientOfLossWrtLayerOutput(const std::vector<double
     return gradients;
 }
 
-// Função principal
-int main()
+// Saídas de um forward pass completo para um exemplo
+struct ForwardResult {
+    Tensor decoder_outputs;
+    Tensor probabilities;
+};
+
+// Função que executa embedding, codificação posicional, encoder, decoder e camada final para um exemplo
+ForwardResult runForward(std::span<const int> tokens, const Embedding& embedding, const PositionalEncoding& pe,
+                         Encoder& encoder, Decoder& decoder, const FinalLayer& finalLayer)
+{
+    Tensor *embedded = embedding.tokenToEmbeddings(tokens);
+    Tensor *encoded = pe.getEncodings(*embedded);
+    Tensor encoder_outputs = encoder.forward(*encoded);
+    Tensor *decoder_outputs = decoder.forward(*encoded, encoder_outputs);
+
+    ForwardResult result{*decoder_outputs, finalLayer.forward(*decoder_outputs)};
+    delete embedded;
+    delete encoded;
+    delete decoder_outputs;
+    return result;
+}
+
+// Relatório de precisão da inferência INT8: roda o dataset com os pesos em ponto flutuante, quantiza o modelo
+// e roda de novo, comparando as saídas do decoder, as probabilidades e a perda
+void runInt8Report(const std::vector<std::span<const int>>& input_tokens, const std::vector<std::span<const int>>& output_tokens,
+                   const Embedding& embedding, const PositionalEncoding& pe, Encoder& encoder, Decoder& decoder, FinalLayer& finalLayer)
 {
+    // Passada de referência em ponto flutuante
+    std::vector<ForwardResult> reference;
+    for (const auto& tokens : input_tokens) {
+        reference.push_back(runForward(tokens, embedding, pe, encoder, decoder, finalLayer));
+    }
+    size_t float_bytes = encoder.weightBytes() + decoder.weightBytes() + finalLayer.weightBytes();
+
+    // Quantização offline dos pesos (encoder, decoder e camada final)
+    encoder.quantizeWeights();
+    decoder.quantizeWeights();
+    finalLayer.quantizeWeights();
+    size_t int8_bytes = encoder.weightBytes() + decoder.weightBytes() + finalLayer.weightBytes();
+
+    // Passada quantizada e comparação com a referência
+    double squared_error = 0.0, squared_norm = 0.0, max_probability_error = 0.0;
+    double float_loss = 0.0, int8_loss = 0.0;
+    size_t positions = 0, top1_matches = 0, scored = 0;
+    for (size_t i = 0; i < input_tokens.size(); ++i) {
+        ForwardResult quantized = runForward(input_tokens[i], embedding, pe, encoder, decoder, finalLayer);
+        const ForwardResult& ref = reference[i];
+
+        for (size_t t = 0; t < ref.decoder_outputs.rows(); ++t) {
+            std::span<const real_t> a = std::as_const(ref.decoder_outputs).row(t);
+            std::span<const real_t> b = std::as_const(quantized.decoder_outputs).row(t);
+            for (size_t j = 0; j < a.size(); ++j) {
+                squared_error += (double(a[j]) - b[j]) * (double(a[j]) - b[j]);
+                squared_norm += double(a[j]) * a[j];
+            }
+
+            std::span<const real_t> p = std::as_const(ref.probabilities).row(t);
+            std::span<const real_t> q = std::as_const(quantized.probabilities).row(t);
+            for (size_t j = 0; j < p.size(); ++j) {
+                max_probability_error = std::max(max_probability_error, std::abs(double(p[j]) - q[j]));
+            }
+            top1_matches += std::max_element(p.begin(), p.end()) - p.begin() == std::max_element(q.begin(), q.end()) - q.begin();
+            ++positions;
+
+            // Perda contra o token alvo, nas posições que têm alvo
+            if (t < output_tokens[i].size()) {
+                float_loss += computeCrossEntropyLoss(p, output_tokens[i][t]);
+                int8_loss += computeCrossEntropyLoss(q, output_tokens[i][t]);
+                ++scored;
+            }
+        }
+    }
+
+    std::cout << "Relatorio INT8 (GEMM INT8: " << VectorMath::gemmInt8Backend() << ")" << std::endl;
+    std::cout << "Pesos: " << float_bytes << " bytes em ponto flutuante, " << int8_bytes << " bytes em INT8 ("
+              << double(float_bytes) / int8_bytes << "x menor)" << std::endl;
+    std::cout << "Erro relativo das saidas do decoder: " << std::sqrt(squared_error / squared_norm) << std::endl;
+    std::cout << "Maior diferenca de probabilidade: " << max_probability_error << std::endl;
+    std::cout << "Concordancia top-1: " << top1_matches << " / " << positions << std::endl;
+    if (scored > 0) {
+        std::cout << "Erro Medio (ponto flutuante): " << float_loss / scored << std::endl;
+        std::cout << "Erro Medio (INT8): " << int8_loss / scored << std::endl;
+    }
+}
+
+// Nome da opção --ffn-activation correspondente a uma ativação
+const char* activationName(ActivationFunction activation)
+{
+    switch (activation) {
+        case ActivationFunction::ReLU: return "relu";
+        case ActivationFunction::GELU: return "gelu";
+        case ActivationFunction::SwiGLU: return "swiglu";
+        default: return "none";
+    }
+}
+
+// Função que grava vocabulário e pesos de todo o modelo em um checkpoint binário. Os hiperparâmetros que não aparecem
+// nas formas dos pesos (número de cabeças e ativação das FFNs) vão na seção model.config.
+void saveCheckpoint(const std::string& path, const Tokenizer& tok, const Embedding& embedding,
+                    const Encoder& encoder, const Decoder& decoder, const FinalLayer& finalLayer,
+                    int num_heads, ActivationFunction ffn_activation)
+{
+    const uint64_t config[2] = {static_cast<uint64_t>(num_heads), static_cast<uint64_t>(ffn_activation)};
+    CheckpointWriter writer;
+    writer.addArray("model.config", std::span<const uint64_t>(config));
+    tok.saveVocab(writer);
+    embedding.saveParameters(writer, "embedding");
+    encoder.saveParameters(writer, "encoder");
+    decoder.saveParameters(writer, "decoder");
+    finalLayer.saveParameters(writer, "final");
+    writer.write(path);
+    std::cout << "Checkpoint salvo em " << path << std::endl;
+}
+
+// Função que lê a seção model.config: o número de cabeças precisa coincidir com o do programa e a ativação vem do
+// checkpoint (ou precisa coincidir com --ffn-activation, se a opção foi passada). Retorna false após exibir o erro.
+// Checkpoints gravados sem essa seção mantêm as opções da linha de comando.
+bool loadCheckpointConfig(const CheckpointReader& reader, int num_heads, ActivationFunction& ffn_activation, bool activation_given)
+{
+    if (!reader.contains("model.config")) {
+        return true;
+    }
+    std::span<const uint64_t> config = reader.uint64Array("model.config");
+    if (config.size() != 2 || config[1] < static_cast<uint64_t>(ActivationFunction::ReLU) ||
+        config[1] > static_cast<uint64_t>(ActivationFunction::SwiGLU)) {
+        throw std::runtime_error("loadCheckpointConfig: seção model.config inválida");
+    }
+    const ActivationFunction stored_activation = static_cast<ActivationFunction>(config[1]);
+    if (config[0] != static_cast<uint64_t>(num_heads)) {
+        std::cout << "Error: checkpoint was saved with " << config[0] << " attention heads, expected " << num_heads << std::endl;
+        return false;
+    }
+    if (activation_given && stored_activation != ffn_activation) {
+        std::cout << "Error: checkpoint was saved with --ffn-activation " << activationName(stored_activation)
+                  << ", not " << activationName(ffn_activation) << std::endl;
+        return false;
+    }
+    ffn_activation = stored_activation;
+    return true;
+}
+
+// Função que carrega os pesos de todo o modelo de um checkpoint (o vocabulário é carregado antes, na tokenização)
+void loadCheckpoint(const CheckpointReader& reader, Embedding& embedding, Encoder& encoder, Decoder& decoder, FinalLayer& finalLayer)
+{
+    embedding.loadParameters(reader, "embedding");
+    encoder.loadParameters(reader, "encoder");
+    decoder.loadParameters(reader, "decoder");
+    finalLayer.loadParameters(reader, "final");
+}
+
+// Função principal. Opções:
+//   --int8-report             roda apenas o relatório de precisão da inferência INT8
+//   --save-checkpoint <file>  grava vocabulário e pesos em um checkpoint binário antes de rodar
+//   --load-checkpoint <file>  usa o vocabulário e os pesos de um checkpoint (mapeado em memória, sem cópia)
+//   --save-vocab <file>       grava o vocabulário congelado no formato binário (mapeável com mmap)
+//   --load-vocab <file>       usa um vocabulário binário gravado com --save-vocab (palavras novas viram <unk>)
+//   --dataset-cache <file>    usa o dataset já tokenizado em <file> (mapeado em memória); se o arquivo não existir,
+//                             tokeniza dados/dataset.txt e grava o cache para as próximas execuções
+//   --bpe-vocab <n>           treina um vocabulário BPE de até n tokens sobre o dataset, em vez de um token por palavra
+//                             (n precisa cobrir os 256 bytes e os tokens especiais, ou seja, pelo menos 257)
+//   --stream                  lê e tokeniza dados/dataset.txt aos poucos, em segundo plano, sem carregar o arquivo
+//                             inteiro (exige um vocabulário pronto: --load-vocab, --load-checkpoint ou um cache existente)
+//   --prefetch <n>            número de exemplos preparados com antecedência pela thread de leitura (padrão 4)
+//   --token-budget <n>        posições (sequências x maior comprimento, padding incluído) por forward pass (padrão 256)
+//   --bucket-width <n>        largura dos buckets de comprimento usados para formar os lotes (padrão 4)
+//   --pack <n>                empacota vários exemplos em cada sequência de n posições, em vez de completá-los com padding
+//   --threads <n>             número de threads do pool usado pelo GEMM e pelos laços por posição (padrão: um por
+//                             núcleo, ou BUMBLEBEE_NUM_THREADS)
+//   --pin-threads             prende cada thread do pool a um núcleo (também via BUMBLEBEE_PIN_THREADS=1)
+//   --pipeline <n>            divide as camadas do encoder, do decoder e a camada final em n estágios, cada um na sua
+//                             thread, e processa lotes diferentes em estágios diferentes ao mesmo tempo
+//   --ffn-activation <nome>   ativação das redes feedforward: relu (padrão), gelu ou swiglu (com --load-checkpoint,
+//                             vale a gravada no checkpoint)
+//   --loss-only               calcula apenas a perda (cross-entropy fundida na camada final, sem montar as
+//                             probabilidades), sem amostrar nem exibir as respostas
+int main(int argc, char** argv)
+{
+    // Lendo as opções da linha de comando
+    bool int8_report = false;
+    std::string save_path, load_path, save_vocab_path, load_vocab_path, dataset_cache_path;
+    int bpe_vocab = 0;
+    bool stream = false;
+    int prefetch = 4;
+    int token_budget = 256;
+    int bucket_width = 4;
+    int pack_len = 0;
+    int threads = -1;
+    bool pin_threads = false;
+    int pipeline_stages = 0;
+    ActivationFunction ffn_activation = ActivationFunction::ReLU;
+    bool ffn_activation_given = false;
+    bool loss_only = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--int8-report") == 0) {
+            int8_report = true;
+        } else if (std::strcmp(argv[i], "--save-checkpoint") == 0 && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--load-checkpoint") == 0 && i + 1 < argc) {
+            load_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--save-vocab") == 0 && i + 1 < argc) {
+            save_vocab_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--load-vocab") == 0 && i + 1 < argc) {
+            load_vocab_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--dataset-cache") == 0 && i + 1 < argc) {
+            dataset_cache_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--bpe-vocab") == 0 && i + 1 < argc) {
+            bpe_vocab = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--stream") == 0) {
+            stream = true;
+        } else if (std::strcmp(argv[i], "--prefetch") == 0 && i + 1 < argc) {
+            prefetch = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--token-budget") == 0 && i + 1 < argc) {
+            token_budget = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--bucket-width") == 0 && i + 1 < argc) {
+            bucket_width = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc) {
+            pack_len = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--pin-threads") == 0) {
+            pin_threads = true;
+        } else if (std::strcmp(argv[i], "--pipeline") == 0 && i + 1 < argc) {
+            pipeline_stages = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--loss-only") == 0) {
+            loss_only = true;
+        } else if (std::strcmp(argv[i], "--ffn-activation") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            ffn_activation_given = true;
+            if (std::strcmp(name, "relu") == 0) {
+                ffn_activation = ActivationFunction::ReLU;
+            } else if (std::strcmp(name, "gelu") == 0) {
+                ffn_activation = ActivationFunction::GELU;
+            } else if (std::strcmp(name, "swiglu") == 0) {
+                ffn_activation = ActivationFunction::SwiGLU;
+            } else {
+                std::cout << "Error: unknown activation " << name << std::endl;
+                return 1;
+            }
+        } else {
+            std::cout << "Error: unknown option " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    // O pipeline entrega as probabilidades de cada lote, que o modo --loss-only evita montar
+    if (loss_only && pipeline_stages > 0) {
+        std::cout << "Error: --loss-only cannot be combined with --pipeline" << std::endl;
+        return 1;
+    }
+
+    // As opções de threads substituem as variáveis de ambiente e precisam valer antes do primeiro uso do pool
+    if (threads >= 0 || pin_threads) {
+        ThreadPool::configureGlobal(threads >= 0 ? static_cast<size_t>(threads) : 0, pin_threads);
+    }
+
     // Inicializando o tokenizador
     Tokenizer tok;  
 
-    // Variável para manipular o arquivo
-    std::fstream file;  
+    // Com --load-checkpoint, o vocabulário salvo é carregado antes da tokenização, para que os IDs coincidam com os pesos
+    std::unique_ptr<CheckpointReader> checkpoint;
+    if (!load_path.empty()) {
+        checkpoint = std::make_unique<CheckpointReader>(load_path);
+        tok.loadVocab(*checkpoint);
+        if (!tok.isBPE()) {
+            tok.freeze();
+        }
+    } else if (!load_vocab_path.empty()) {
+        tok.loadBinaryVocab(load_vocab_path);
+    }
 
-    // Abrindo o arquivo de dados
-    file.open("./dados/dataset.txt", std::ios::in);  
+    // Definindo o token de finalização
+    std::string end_token = "<end>";  
 
-    // Vetor para armazenar as linhas do arquivo
-    std::vector<std::string> text;  
+    // Vetor para armazenar os tokens das entradas
+    std::vector<std::span<const int>> input_tokens;  
+    // Vetor para armazenar os tokens das saídas
+    std::vector<std::span<const int>> output_tokens;  
 
-    // Lendo o arquivo linha por linha
-    if (file.is_open())
+    // Dataset já tokenizado (quando --dataset-cache aponta para um cache existente) ou tokenizado agora a partir do texto
+    std::unique_ptr<DatasetCache> dataset_cache;
+    TokenizedCorpus corpus_tokens;
+
+    if (!dataset_cache_path.empty() && std::filesystem::exists(dataset_cache_path))
     {
-        std::string line;
-        while (std::getline(file, line))
-        {
-            if (line.empty())
-            {
-                continue;  // Ignorando linhas vazias
+        // Mapeando o cache: nenhuma etapa de processamento de texto é necessária
+        dataset_cache = std::make_unique<DatasetCache>(dataset_cache_path);
+        if (!checkpoint && load_vocab_path.empty()) {
+            dataset_cache->loadVocab(tok);
+            if (!tok.isBPE()) {
+                tok.freeze();
             }
+        }
+        if (tok.getVocabSize() != dataset_cache->vocabSize()) {
+            std::cout << "Error: dataset cache was built with a different vocabulary" << std::endl;
+            return 1;
+        }
+        // O loop principal lê os pares direto do cache; só o relatório INT8 precisa da lista de todos os pares
+        for (size_t i = 0; int8_report && i < dataset_cache->size(); ++i)
+        {
+            input_tokens.push_back(dataset_cache->input(i));
+            output_tokens.push_back(dataset_cache->output(i));
+        }
 
-            text.push_back(line);  // Adicionando linha ao vetor de texto
+        // Exibindo o número de linhas do cache
+        std::cout << 2 * dataset_cache->size() << std::endl;
+    }
+    else if (stream)
+    {
+        // No modo streaming, o texto é lido e tokenizado durante o loop principal, com o vocabulário já pronto
+        if (!tok.isBPE() && !tok.isFrozen()) {
+            std::cout << "Error: --stream needs a vocabulary (--load-vocab, --load-checkpoint or an existing --dataset-cache)" << std::endl;
+            return 1;
+        }
+        if (int8_report || !dataset_cache_path.empty()) {
+            std::cout << "Error: --stream cannot be combined with --int8-report or with building a dataset cache" << std::endl;
+            return 1;
         }
-        file.close();  // Fechando o arquivo
     }
     else
     {
-        // Erro se o arquivo não for encontrado
-        std::cout << "Error: File not found" << std::endl;  
-        return 1;  // Saída com código de erro
-    }
+        // Variável para manipular o arquivo
+        std::fstream file;  
 
-    // Exibindo o número de linhas lidas
-    std::cout << text.size() << std::endl;  
+        // Abrindo o arquivo de dados
+        file.open("./dados/dataset.txt", std::ios::in);  
 
-    // Vetor para armazenar as entradas
-    std::vector<std::string> input_text;  
-    // Vetor para armazenar as saídas esperadas
-    std::vector<std::string> output_text;  
-    // Vetor para armazenar os tokens das entradas
-    std::vector<std::vector<int>> input_tokens;  
-    // Vetor para armazenar os tokens das saídas
-    std::vector<std::vector<int>> output_tokens;  
+        // Conteúdo completo do arquivo e vetor para armazenar as linhas
+        std::string corpus;
+        std::vector<std::string> text;  
 
+        // Lendo o arquivo inteiro de uma vez e separando as linhas
+        if (file.is_open())
+        {
+            corpus.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            file.close();  // Fechando o arquivo
 
-    // O loop só continua enquanto i+1 for um índice válido.
-    for (size_t i = 0; i + 1 < text.size(); i += 2)
-    {
-        input_text.push_back(text[i]);
-        output_text.push_back(text[i + 1]);
-        input_tokens.push_back(tok.tokenize(text[i]));
-        output_tokens.push_back(tok.tokenize(text[i + 1]));
+            std::istringstream lines(corpus);
+            std::string line;
+            while (std::getline(lines, line))
+            {
+                if (line.empty())
+                {
+                    continue;  // Ignorando linhas vazias
+                }
+
+                text.push_back(line);  // Adicionando linha ao vetor de texto
+            }
+        }
+        else
+        {
+            // Erro se o arquivo não for encontrado
+            std::cout << "Error: File not found" << std::endl;  
+            return 1;  // Saída com código de erro
+        }
+
+        // Exibindo o número de linhas lidas
+        std::cout << text.size() << std::endl;  
+
+        // No modo BPE, o vocabulário é treinado uma vez sobre o dataset, com o token de finalização como token especial
+        if (bpe_vocab > 0 && !checkpoint) {
+            const std::vector<std::string> special_tokens = {end_token};
+            const int min_bpe_vocab = BPE_BYTE_TOKENS + static_cast<int>(special_tokens.size());
+            if (bpe_vocab < min_bpe_vocab) {
+                std::cout << "Error: --bpe-vocab must be at least " << min_bpe_vocab
+                          << " (256 byte tokens plus the special tokens)" << std::endl;
+                return 1;
+            }
+            tok.trainBPE(text, bpe_vocab, special_tokens);
+            std::cout << "BPE vocab size: " << tok.getVocabSize() << std::endl;
+        }
+
+        // Tokenizando todas as linhas em paralelo (os IDs saem iguais aos da tokenização linha a linha)
+        corpus_tokens = tok.tokenizeCorpus(corpus);
+
+        // O loop só continua enquanto i+1 for um índice válido.
+        for (size_t i = 0; i + 1 < corpus_tokens.lines(); i += 2)
+        {
+            input_tokens.push_back(corpus_tokens.line(i));
+            output_tokens.push_back(corpus_tokens.line(i + 1));
+        }
     }
 
-    // Definindo o token de finalização
-    std::string end_token = "<end>";  
     // Pegando o ID do token de finalização
     int end_token_id = tok.tokenize(end_token)[0];  
 
+    // Congelando o vocabulário: daqui em diante a tokenização é somente leitura e palavras novas viram <unk>
+    if (!tok.isBPE() && !tok.isFrozen()) {
+        tok.freeze();
+    }
+    if (!save_vocab_path.empty()) {
+        tok.saveBinaryVocab(save_vocab_path);
+    }
+
+    // Gravando o cache do dataset tokenizado para as próximas execuções
+    if (!dataset_cache_path.empty() && !dataset_cache) {
+        DatasetCache::write(dataset_cache_path, tok, corpus_tokens, tok.getVocabSize());
+        std::cout << "Dataset cache salvo em " << dataset_cache_path << std::endl;
+    }
+
     // Vetor para armazenar as perdas
     std::vector<std::unordered_map<int, double>> losses;  
     // Vetor para armazenar os gradientes
-    std::vector<std::vector<double>> gradients;  
+    std::vector<std::vector<real_t>> gradients;  
 
 
     int model_dim = 128;
+    int num_heads = 8;
     int vocab_size = tok.getVocabSize();
+
+    // Com --load-checkpoint, a ativação das FFNs é a gravada no checkpoint
+    if (checkpoint && !loadCheckpointConfig(*checkpoint, num_heads, ffn_activation, ffn_activation_given)) {
+        return 1;
+    }
     Embedding embedding(vocab_size, model_dim);
     PositionalEncoding pe(640, model_dim);
-    Encoder encoder(6, model_dim);
-    Decoder decoder(6, model_dim);
+    Encoder encoder(6, model_dim, num_heads, ffn_activation);
+    Decoder decoder(6, model_dim, num_heads, ffn_activation);
     FinalLayer finalLayer(model_dim, vocab_size);
 
-    // Loop para processar cada par de entrada e saída
-    for (size_t i = 0; i < input_text.size(); i++)
-    {
-        // Convertendo tokens de entrada para embeddings
-        std::vector<std::vector<double>> *embedded_input = embedding.tokenToEmbeddings(input_tokens[i]);  
-        // Convertendo tokens de saída para embeddings
-        std::vector<std::vector<double>> *embedded_output = embedding.tokenToEmbeddings(output_tokens[i]); 
-        
-        // Aplicando codificações posicionais aos embeddings de entrada
-        std::vector<std::vector<double>> *encoded_inputs = pe.getEncodings(*embedded_input);  
-        // Aplicando codificações posicionais aos embeddings de saída
-        std::vector<std::vector<double>> *encoded_outputs = pe.getEncodings(*embedded_output);  
+    // Carregando e/ou salvando os pesos do modelo
+    if (checkpoint) {
+        loadCheckpoint(*checkpoint, embedding, encoder, decoder, finalLayer);
+        std::cout << "Checkpoint carregado de " << load_path << std::endl;
+    }
+    if (!save_path.empty()) {
+        saveCheckpoint(save_path, tok, embedding, encoder, decoder, finalLayer, num_heads, ffn_activation);
+    }
 
-        // Passando os dados pelo encoder
-        std::vector<std::vector<double>> encoder_outputs_val = encoder.forward(*encoded_inputs);  
+    // Exibindo o conjunto de instruções escolhido para o GEMM
+    std::cout << "GEMM: " << VectorMath::gemmBackend() << " (CPU: " << CpuFeatures::get().describe() << ")" << std::endl;
 
-        // Passando os dados pelo decoder
-        std::vector<std::vector<double>> *decoder_outputs = decoder.forward((*encoded_inputs), encoder_outputs_val);  
-        
-        // Vetor para armazenar as probabilidades de saída
-        std::vector<std::vector<double>> output_probabilities;  
+    // Relatório de precisão da inferência INT8 contra o caminho em ponto flutuante
+    if (int8_report) {
+        runInt8Report(input_tokens, output_tokens, embedding, pe, encoder, decoder, finalLayer);
+        return 0;
+    }
 
-        // Passando os outputs do decoder pela camada final para obter as probabilidades
-        for (const auto &decoder_output : *decoder_outputs)
-        {
-            output_probabilities.push_back(finalLayer.forward(decoder_output));  
+    // Preparação executada na thread de leitura, em paralelo com o forward pass do exemplo anterior. Só a entrada é
+    // codificada: ela alimenta o encoder e o decoder, e os tokens de saída servem apenas de alvo para a perda.
+    auto prepare = [&embedding, &pe, model_dim](Example& example) {
+        std::span<const int> tokens = example.input_tokens;
+        Tensor& encoded = example.encoded_input;
+
+        // Convertendo os tokens (até o comprimento máximo da codificação posicional) para embeddings
+        encoded.resize(pe.encodedLength(tokens.size()), model_dim);
+        embedding.tokenToEmbeddings(tokens.first(encoded.rows()), encoded);
+
+        // Aplicando codificações posicionais aos embeddings, no mesmo tensor
+        pe.getEncodings(encoded, encoded);
+    };
+
+    // Os pares vêm do cache tokenizado (--dataset-cache), do texto (--stream) ou do dataset tokenizado agora, e são
+    // preparados em segundo plano
+    DatasetStream dataset(dataset_cache ? DatasetStream::fromCache(*dataset_cache)
+                          : stream    ? DatasetStream::fromText("./dados/dataset.txt", tok)
+                                      : DatasetStream::fromPairs(input_tokens, output_tokens),
+                          prefetch, prepare);
+
+    // Loop para processar os pares de entrada e saída em lotes de sequências de comprimento parecido
+    BatchScheduler scheduler(token_budget, bucket_width, pack_len > 0);
+    PaddingStats padding;
+
+    // Função que monta o próximo lote [batch, seq, dim] das entradas: um exemplo por sequência, completadas com padding
+    // até a maior, ou vários exemplos por sequência (--pack). A codificação posicional de cada exemplo já começa na
+    // posição 0. Retorna nullptr quando os exemplos acabam.
+    auto formBatch = [&]() -> std::unique_ptr<PipelineBatch> {
+        auto next = std::make_unique<PipelineBatch>();
+        if (!scheduler.next(dataset, next->examples)) {
+            return nullptr;
+        }
+        std::vector<size_t> lengths;
+        std::vector<ConstTensorView> sequences;
+        for (const Example& item : next->examples) {
+            lengths.push_back(item.encoded_input.rows());
+            sequences.push_back(item.encoded_input);
         }
+        next->layout = pack_len > 0 ? BatchLayout::pack(lengths, pack_len) : BatchLayout::fromLengths(lengths);
+        next->input = next->layout.pad(sequences);
+        padding.add(next->layout);
+        return next;
+    };
+
+    // Com --pipeline, os lotes passam pelas camadas em estágios paralelos (e saem na mesma ordem)
+    std::unique_ptr<LayerPipeline> pipeline;
+    if (pipeline_stages > 0) {
+        pipeline = std::make_unique<LayerPipeline>(formBatch, encoder, decoder, finalLayer, pipeline_stages);
+    }
 
-        
-        std::vector<int> current_output_tokens = output_tokens[i];
-
-        if (output_probabilities.size() < current_output_tokens.size()) {
-            size_t size_difference = current_output_tokens.size() - output_probabilities.size();
-            // Adiciona um padding simples com distribuição uniforme para preencher
-            std::vector<double> padding_probs(vocab_size, 1.0/vocab_size);
-            for(size_t k = 0; k < size_difference; ++k) {
-                output_probabilities.push_back(padding_probs);
+    // Sem pipeline, todas as ativações de um forward pass vêm desta arena, esvaziada a cada lote: depois que ela atinge
+    // o tamanho do maior lote, o forward não aloca mais memória
+    ActivationArena arena;
+
+    while (std::unique_ptr<PipelineBatch> current = pipeline ? pipeline->next() : formBatch())
+    {
+        std::vector<Example>& batch = current->examples;
+        const BatchLayout& layout = current->layout;
+        ConstTensorView batch_probabilities = current->probabilities;
+        if (!pipeline) {
+            arena.reset();
+            const size_t rows = current->input.rows();
+
+            // Passando o lote pelo encoder
+            TensorView encoder_outputs = arena.allocate(rows, model_dim);
+            encoder.forward(current->input, layout, encoder_outputs, arena);
+
+            // Passando o lote pelo decoder
+            TensorView decoder_outputs = arena.allocate(rows, model_dim);
+            decoder.forward(current->input, layout, encoder_outputs, layout, decoder_outputs, arena);
+
+            // Só a perda: a camada final calcula a cross-entropy de cada posição por faixas do vocabulário, sem as
+            // probabilidades. O alvo de cada posição do segmento é o token de saída correspondente (ou o token de
+            // finalização, se a saída for mais curta), e o padding do lote é ignorado.
+            if (loss_only) {
+                std::vector<int> targets(rows, -1);
+                for (size_t b = 0; b < batch.size(); ++b) {
+                    const std::vector<int>& tokens = batch[b].output_tokens;
+                    for (size_t j = 0; j < layout.length(b); ++j) {
+                        targets[layout.offset(b) + j] = j < tokens.size() ? tokens[j] : end_token_id;
+                    }
+                }
+                std::vector<double> row_losses(rows);
+                finalLayer.crossEntropy(decoder_outputs, targets, row_losses);
+
+                // Tokens de saída além do segmento recebem a perda da distribuição uniforme, como no modo completo
+                for (size_t b = 0; b < batch.size(); ++b) {
+                    const std::vector<int>& tokens = batch[b].output_tokens;
+                    const size_t scored = std::max(layout.length(b), tokens.size());
+                    for (size_t j = 0; j < scored; ++j) {
+                        int target_token_id = j < layout.length(b) ? targets[layout.offset(b) + j] : tokens[j];
+                        double loss = j < layout.length(b) ? row_losses[layout.offset(b) + j] : -log(1.0 / vocab_size + 1e-9);
+                        losses.push_back({{target_token_id, loss}});
+                    }
+                }
+                continue;
             }
-        } else if (output_probabilities.size() > current_output_tokens.size()) {
-            size_t size_difference = output_probabilities.size() - current_output_tokens.size();
-            current_output_tokens.insert(current_output_tokens.end(), size_difference, end_token_id);
-        }
 
-        // Vetor para armazenar os tokens de resposta amostrados
-        std::vector<int> resp_tokens;  
-        // Vetor para armazenar os tokens com maior probabilidade
-        std::vector<int> resp_tokens_max;  
-        // Inicializando o gerador de números aleatórios
-        std::default_random_engine generator;  
+            // Passando os outputs do decoder pela camada final para obter as probabilidades (uma linha por posição do lote)
+            TensorView probabilities = arena.allocate(rows, vocab_size);
+            finalLayer.forward(decoder_outputs, probabilities);
+            batch_probabilities = probabilities;
+        }
 
-        // Processando os tokens e calculando perdas
-        for (size_t j = 0; j < current_output_tokens.size(); j++)
+        // Perda e resposta de cada exemplo, apenas sobre as linhas do seu segmento (o padding do lote é ignorado)
+        for (size_t b = 0; b < batch.size(); ++b)
         {
-            // Pegando as probabilidades de saída para o token j
-            std::vector<double> output_probability = output_probabilities[j];  
-            // Pegando o token alvo
-            int target_token_id = current_output_tokens[j];  
-
-            std::discrete_distribution<int> distribution(output_probability.begin(), output_probability.end());  
-            int sampled_token_id = distribution(generator);  
-            resp_tokens.push_back(sampled_token_id);  
+            ConstTensorView output_probabilities = layout.sequence(batch_probabilities, b);
+
+            std::vector<int>& current_output_tokens = batch[b].output_tokens;
+
+            Tensor padded_probabilities;
+            if (output_probabilities.rows() < current_output_tokens.size()) {
+                // Adiciona um padding simples com distribuição uniforme para preencher
+                padded_probabilities = Tensor(current_output_tokens.size(), vocab_size, 1.0/vocab_size);
+                for(size_t k = 0; k < output_probabilities.rows(); ++k) {
+                    std::copy(output_probabilities.row(k).begin(), output_probabilities.row(k).end(), padded_probabilities.row(k).begin());
+                }
+                output_probabilities = padded_probabilities;
+            } else if (output_probabilities.rows() > current_output_tokens.size()) {
+                size_t size_difference = output_probabilities.rows() - current_output_tokens.size();
+                current_output_tokens.insert(current_output_tokens.end(), size_difference, end_token_id);
+            }
 
-            int max_token_id = std::distance(output_probability.begin(), std::max_element(output_probability.begin(), output_probability.end()));  
-            resp_tokens_max.push_back(max_token_id);  
+            // Vetor para armazenar os tokens de resposta amostrados
+            std::vector<int> resp_tokens;  
+            // Vetor para armazenar os tokens com maior probabilidade
+            std::vector<int> resp_tokens_max;  
+            // Inicializando o gerador de números aleatórios
+            std::default_random_engine generator;  
 
-            double loss = computeCrossEntropyLoss(output_probability, target_token_id);  
-            std::unordered_map<int, double> temp_loss_map;
-            temp_loss_map[target_token_id] = loss;  
-            losses.push_back(temp_loss_map);  
-        }
+            // Processando os tokens e calculando perdas
+            for (size_t j = 0; j < current_output_tokens.size(); j++)
+            {
+                // Pegando as probabilidades de saída para o token j
+                std::span<const real_t> output_probability = std::as_const(output_probabilities).row(j);  
+                // Pegando o token alvo
+                int target_token_id = current_output_tokens[j];  
+
+                std::discrete_distribution<int> distribution(output_probability.begin(), output_probability.end());  
+                int sampled_token_id = distribution(generator);  
+                resp_tokens.push_back(sampled_token_id);  
+
+                int max_token_id = std::distance(output_probability.begin(), std::max_element(output_probability.begin(), output_probability.end()));  
+                resp_tokens_max.push_back(max_token_id);  
+
+                double loss = computeCrossEntropyLoss(output_probability, target_token_id);  
+                std::unordered_map<int, double> temp_loss_map;
+                temp_loss_map[target_token_id] = loss;  
+                losses.push_back(temp_loss_map);  
+            }
         
-       
-        delete embedded_input;
-        delete embedded_output;
-        delete encoded_inputs;
-        delete encoded_outputs;
-        delete decoder_outputs;
 
-        // Gerando a resposta prevista e removendo o token de finalização
-        std::string response = tok.detokenize(resp_tokens);
-        response = response.substr(0, response.find(end_token));
+            // Gerando a resposta prevista e removendo o token de finalização
+            std::string response = tok.detokenize(resp_tokens);
+            response = response.substr(0, response.find(end_token));
 
-        std::cout << "Valor Previsto: \n" << response << std::endl;  
+            std::cout << "Valor Previsto: \n" << response << std::endl;  
 
-        std::string actual_response = tok.detokenize(current_output_tokens);
-        actual_response = actual_response.substr(0, actual_response.find(end_token));
+            std::string actual_response = tok.detokenize(current_output_tokens);
+            actual_response = actual_response.substr(0, actual_response.find(end_token));
 
-        std::cout << "Valor Real: \n" << actual_response << std::endl;  
-        std::cout << std::endl;
+            std::cout << "Valor Real: \n" << actual_response << std::endl;  
+            std::cout << std::endl;
+        }
     }
 
+    // Exibindo a eficiência dos lotes: fração das posições processadas que não são padding
+    std::cout << "Padding: " << padding.tokens << " posicoes validas de " << padding.padded_tokens << " processadas ("
+              << 100.0 * padding.efficiency() << "%) em " << padding.batches << " lotes de " << padding.sequences
+              << " sequencias" << std::endl;
+
     // Calculando o erro total e médio
     double total_loss = 0.0;
     for (const auto &loss_map : losses)
@@ -31,6 +31,12 @@
 // Inclui a biblioteca padrão de fluxos de strings
 #include <sstream>
 
+// Inclui o tipo Tensor, que guarda a matriz de embeddings em um bloco contíguo
+#include "Tensor.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar a matriz de embeddings
+#include "Checkpoint.hpp"
+
 // Declaração da classe Embedding
 class Embedding
 {
@@ -46,28 +52,36 @@ private:
     // Tamanho máximo da sequência
     int max_seq_len;
     
-    // Ponteiro para a matriz de embeddings
-    std::vector<std::vector<double>> *embedding_matrix;
+    // Ponteiro para a matriz de embeddings (vocab_size x embed_dim)
+    Tensor *embedding_matrix;
 
 public:
     
     // Construtor que inicializa vocab_size e embed_dim
     Embedding(int vocab_size, int embed_dim);
     
-    // Retorna o vetor de embedding para um token específico, identificado por token_id
-    std::vector<double> getEmbedding(int token_id);
+    // Retorna o vetor de embedding para um token específico, identificado por token_id (sem cópia)
+    std::span<const real_t> getEmbedding(int token_id) const;
     
-    // Converte uma sequência de tokens em uma sequência de embeddings
-    std::vector<std::vector<double>> *tokenToEmbeddings(std::vector<int> tokens);
+    // Converte uma sequência de tokens em uma sequência de embeddings (seq_len x embed_dim)
+    Tensor *tokenToEmbeddings(std::span<const int> tokens) const;
+
+    // Versão que escreve os embeddings em output (tokens.size() x embed_dim), sem alocar memória
+    void tokenToEmbeddings(std::span<const int> tokens, TensorView output) const;
     
     // Salva a matriz de embeddings em um arquivo
     void saveEmbeddingMatrix(const std::string &filename);
     
     // Carrega a matriz de embeddings de um arquivo
     void loadEmbeddingMatrix(const std::string &filename);
+
+    // Salva e carrega a matriz de embeddings como a seção prefix.matrix de um checkpoint binário
+    // (a matriz carregada aponta direto para o arquivo mapeado, sem cópia)
+    void saveParameters(CheckpointWriter &writer, const std::string &prefix) const;
+    void loadParameters(const CheckpointReader &reader, const std::string &prefix);
     
     // Gera uma matriz de embeddings aleatória com base no tamanho do vocabulário e dimensão de embedding
-    std::vector<std::vector<double>> *generateRandomEmbeddingMatrix(int embed_dim, int vocab_size);
+    Tensor *generateRandomEmbeddingMatrix(int embed_dim, int vocab_size);
 
     // Imprime a matriz de embeddings no console
     void printEmbeddingMatrix();
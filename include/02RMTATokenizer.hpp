@@ -22,6 +22,24 @@
 // Inclui a biblioteca padrão para manipulação de arquivos
 #include <fstream>
 
+// Inclui o tipo Tensor, usado na codificação one-hot
+#include "Tensor.hpp"
+
+// Inclui std::optional, usado no modo BPE
+#include <optional>
+
+// Inclui o tokenizador de subpalavras BPE
+#include "BPETokenizer.hpp"
+
+// Inclui o vocabulário congelado, usado na tokenização somente leitura
+#include "FrozenVocab.hpp"
+
+// Inclui o resultado da tokenização de um corpus inteiro
+#include "TokenizedCorpus.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar o vocabulário
+#include "Checkpoint.hpp"
+
 // Declaração da classe Tokenizer
 class Tokenizer
 {
@@ -37,6 +55,12 @@ private:
     // Tamanho do vocabulário (número de palavras únicas no vocabulário)
     int vocab_size;
 
+    // Vocabulário BPE; quando presente (trainBPE ou loadVocab), substitui a tokenização por palavras
+    std::optional<BPETokenizer> bpe;
+
+    // Vocabulário congelado (freeze); quando presente, a tokenização por palavras não modifica mais o vocabulário
+    std::optional<FrozenVocab> frozen;
+
 public:
     
     // Construtor da classe Tokenizer
@@ -44,6 +68,32 @@ public:
     
     // Função que transforma um texto em uma sequência de IDs de tokens
     std::vector<int> tokenize(std::string text);
+
+    // Função que treina um vocabulário BPE de até vocab_size tokens sobre as linhas de corpus e passa a usá-lo.
+    // Diferente do modo por palavras, o vocabulário fica fixo: textos novos nunca aumentam vocab_size.
+    void trainBPE(const std::vector<std::string>& corpus, int vocab_size, const std::vector<std::string>& special_tokens = {});
+
+    // Função que indica se o tokenizador está no modo BPE
+    bool isBPE() const { return bpe.has_value(); }
+
+    // Função que congela o vocabulário por palavras (acrescentando "<unk>" se necessário): a partir daqui, palavras
+    // desconhecidas viram <unk> em vez de ganhar um ID novo, e tokenize passa a ser somente leitura
+    void freeze();
+
+    // Função que indica se o vocabulário está congelado
+    bool isFrozen() const { return frozen.has_value(); }
+
+    // Tokenização somente leitura e segura entre threads: percorre o texto sem cópias e escreve os IDs em 'output'.
+    // Retorna o número total de tokens (se for maior que output.size(), apenas os primeiros foram escritos).
+    // Exige o vocabulário congelado ou o modo BPE.
+    std::size_t tokenize(std::string_view text, std::span<int> output) const;
+
+    // Função que tokeniza um corpus inteiro (uma frase por linha; linhas vazias são ignoradas) em paralelo.
+    // O texto é dividido em faixas de bytes terminadas em fim de linha, uma por tarefa do pool. Sem vocabulário
+    // congelado, cada faixa monta um vocabulário local e, no fim, as faixas são combinadas em ordem: os IDs novos
+    // saem na mesma ordem de primeira ocorrência da tokenização serial, independentemente do número de threads.
+    // num_threads = 0 usa o pool global.
+    TokenizedCorpus tokenizeCorpus(std::string_view corpus, std::size_t num_threads = 0);
     
     // Função que retorna o tamanho do vocabulário
     int getVocabSize();
@@ -59,9 +109,20 @@ public:
     
     // Função que carrega o mapa de tokens de um arquivo
     void loadTokenMap(std::string filename);
+
+    // Funções que salvam e carregam o vocabulário congelado no formato binário de FrozenVocab. O arquivo é mapeado
+    // com mmap e usado como está (a tabela hash vem pronta), então o tempo de carga não depende do tamanho do vocabulário.
+    void saveBinaryVocab(const std::string& filename) const;
+    void loadBinaryVocab(const std::string& filename);
+
+    // Funções que salvam e carregam o vocabulário como a seção de bytes "tokenizer.vocab" de um checkpoint:
+    // [uint32 count][uint32 offsets[count + 1]][caracteres das palavras, na ordem dos IDs].
+    // No modo BPE, a seção é "tokenizer.bpe" (ver BPETokenizer::serialize).
+    void saveVocab(CheckpointWriter& writer) const;
+    void loadVocab(const CheckpointReader& reader);
     
-    // Função que gera uma codificação one-hot para um token específico
-    std::vector<std::vector<double>> oneHotEncode(int token_id);
+    // Função que gera uma codificação one-hot (1 x vocab_size) para um token específico
+    Tensor oneHotEncode(int token_id);
     
     // Destrutor da classe Tokenizer
     ~Tokenizer();
@@ -19,6 +19,9 @@
 // Inclui a biblioteca padrão de entrada e saída para depuração e exibição
 #include <iostream>
 
+// Inclui o tipo Tensor, que guarda a matriz de codificações em um bloco contíguo
+#include "Tensor.hpp"
+
 // Declaração da classe PositionalEncoding
 class PositionalEncoding {
 
@@ -28,10 +31,17 @@ public:
     PositionalEncoding(int max_seq_len, int model_dim);
     
     // Função que retorna a codificação posicional para uma posição específica
-    const std::vector<double>& getEncoding(int pos);
+    std::span<const real_t> getEncoding(int pos) const;
     
     // Função que aplica a codificação posicional a um conjunto de embeddings e retorna um ponteiro para os embeddings modificados
-    std::vector<std::vector<double>> *getEncodings(std::vector<std::vector<double>> &embeddings);
+    Tensor *getEncodings(const Tensor &embeddings) const;
+
+    // Versão que escreve em output (que pode ser a própria matriz de embeddings); output deve ter
+    // encodedLength(embeddings.rows()) linhas
+    void getEncodings(ConstTensorView embeddings, TensorView output) const;
+
+    // Número de posições codificadas para uma sequência de 'length' embeddings (no máximo max_seq_len)
+    size_t encodedLength(size_t length) const { return std::min(length, encoding_matrix.rows()); }
 
 private:
     
@@ -42,7 +52,7 @@ private:
     int model_dim;
     
     // Matriz que armazena as codificações posicionais para cada posição da sequência
-    std::vector<std::vector<double>> encoding_matrix;
+    Tensor encoding_matrix;
 };
 
 // Encerra o bloco de definição condicional de POSITIONAL_ENCODING_H
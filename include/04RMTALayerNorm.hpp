@@ -22,6 +22,15 @@
 // Inclui a biblioteca padrão para operações numéricas (como soma)
 #include <numeric>
 
+// Inclui std::span, usado para normalizar linhas de um Tensor sem cópia
+#include <span>
+
+// Inclui o tipo escalar do modelo (real_t)
+#include "Tensor.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar gamma e beta
+#include "Checkpoint.hpp"
+
 // Declaração da classe LayerNorm, que implementa a normalização por camada
 class LayerNorm {
 
@@ -30,8 +39,19 @@ public:
     // Construtor que inicializa a dimensão do modelo e os vetores gamma e beta
     explicit LayerNorm(int model_dim);
 
-    // Função que aplica a normalização nos dados de entrada
-    std::vector<double> normalize(const std::vector<double>& input) const;
+    // Função que aplica a normalização nos dados de entrada, escrevendo o resultado em output (pode ser o próprio input)
+    void normalize(std::span<const real_t> input, std::span<real_t> output) const;
+
+    // Função que aplica a soma residual seguida da normalização em um bloco [posições x model_dim]: cada linha de
+    // output recebe norm(residual + input). É um kernel fundido: a primeira passada soma, grava a soma em output e
+    // acumula média e variância de uma vez (Welford); a segunda normaliza em output com gamma e beta de cada feature.
+    // output pode ser o próprio residual ou input. As linhas são divididas entre as threads do ThreadPool global.
+    // Retorna false se alguma linha teve média ou variância NaN (entrada com NaN ou infinito).
+    bool addNormalize(ConstTensorView residual, ConstTensorView input, TensorView output) const;
+
+    // Funções que salvam e carregam gamma e beta como as seções prefix.gamma e prefix.beta de um checkpoint
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const;
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix);
 
 private:
     
@@ -39,7 +59,7 @@ private:
     int model_dim;
     
     // Vetor de escala (gamma) e deslocamento (beta) para a normalização
-    std::vector<double> gamma, beta;
+    std::vector<real_t> gamma, beta;
 };
 
 #endif
@@ -28,9 +28,52 @@
 // Inclui exceções padrão
 #include <stdexcept>
 
+// Inclui std::numeric_limits (máximo inicial da softmax online)
+#include <limits>
+
 // Inclui a biblioteca padrão para gerar números aleatórios
 #include <random>
 
+// Inclui std::pair
+#include <utility>
+
+// Inclui o tipo Tensor, que guarda as matrizes de pesos em blocos contíguos
+#include "Tensor.hpp"
+
+// Inclui o GEMM usado nas projeções
+#include "VectorOp.hpp"
+
+// Inclui o pool de threads usado para executar as cabeças em paralelo
+#include "ThreadPool.hpp"
+
+// Inclui o cache de keys/values usado na decodificação incremental
+#include "KVCache.hpp"
+
+// Inclui a disposição de lotes de sequências com padding
+#include "BatchLayout.hpp"
+
+// Inclui a arena que guarda as ativações intermediárias do forward
+#include "ActivationArena.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar os pesos
+#include "Checkpoint.hpp"
+
+// A partir deste número de keys o modo Auto troca a matriz de scores completa pelo kernel em blocos
+constexpr size_t FLASH_ATTENTION_MIN_KEYS = 256;
+
+// Kernels disponíveis para calcular a atenção de cada cabeça
+enum class AttentionKernel {
+
+    // Materializa a matriz de scores completa (seq_len x seq_len) e aplica a softmax por linha
+    Standard,
+
+    // Percorre K/V em blocos com softmax online (máximo e soma acumulados), sem materializar os scores
+    Flash,
+
+    // Usa Flash quando há mais de FLASH_ATTENTION_MIN_KEYS keys e Standard caso contrário
+    Auto
+};
+
 // Declaração da classe SelfAttention, que implementa o mecanismo de atenção
 class SelfAttention {
 
@@ -38,26 +81,125 @@ private:
     
     // Dimensão do modelo (tamanho da representação vetorial)
     int model_dim;
+
+    // Número de cabeças de atenção e dimensão de cada cabeça (model_dim / num_heads)
+    int num_heads;
+    int head_dim;
     
-    // Matrizes de pesos para as transformações de query (W_q), key (W_k) e value (W_v)
-    std::vector<std::vector<double>> W_q, W_k, W_v;
+    // Matrizes de pesos para as transformações de query (W_q), key (W_k) e value (W_v).
+    // A cabeça h usa as linhas [h * head_dim, (h + 1) * head_dim) de cada matriz.
+    Tensor W_q, W_k, W_v;
+
+    // Projeção de saída aplicada à concatenação das cabeças (usada apenas com num_heads > 1)
+    Tensor W_o;
+
+    // Versões INT8 das matrizes de pesos; quando preenchidas (quantizeWeights), substituem as versões em ponto flutuante
+    QuantizedMatrix W_q_int8, W_k_int8, W_v_int8, W_o_int8;
+
+    // Kernel usado no cálculo da atenção
+    AttentionKernel kernel = AttentionKernel::Auto;
+
+    // Atenção causal: a posição i só enxerga as posições 0..i (usada na self-attention do decoder)
+    bool causal = false;
+
+    // Função que projeta todas as posições com uma das matrizes de pesos (input * W^T), em INT8 quando quantizada
+    Tensor multiply(ConstTensorView input, const Tensor &weights, const QuantizedMatrix &quantized) const;
+
+    // Função que calcula a atenção de todas as cabeças (em paralelo) e aplica W_o
+    Tensor attend(ConstTensorView Q, ConstTensorView K, ConstTensorView V) const;
+
+    // Versão para lotes: as queries do exemplo b (segmento b de query_layout) atendem apenas às keys/values do exemplo b
+    // (segmento b de key_layout). Cada par (exemplo, cabeça) é uma tarefa do pool; as linhas de padding saem zeradas.
+    // Escreve em output e usa a arena para a concatenação das cabeças.
+    void attend(ConstTensorView Q, ConstTensorView K, ConstTensorView V, const BatchLayout &query_layout, const BatchLayout &key_layout,
+                TensorView output, ActivationArena &arena) const;
+
+    // Função que atende a query já projetada em scratch.query a todas as posições válidas do cache
+    void attendCached(const KVCache &cache, AttentionScratch &scratch, TensorView output) const;
+
+    // Função que calcula a atenção de uma cabeça: softmax(q k^T / sqrt(head_dim)) * v, escrevendo em output
+    void attendHead(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const;
+
+    // Versão que materializa a matriz de scores completa
+    void attendHeadStandard(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const;
+
+    // Versão em blocos com softmax online: a memória extra é O(bloco de queries x bloco de keys), independente de seq_len
+    void attendHeadFlash(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const;
 
 public:
 
-    // Construtor que inicializa a dimensão do modelo e os pesos da atenção
-    explicit SelfAttention(int model_dim);
+    // Construtor que inicializa a dimensão do modelo, o número de cabeças e os pesos da atenção
+    explicit SelfAttention(int model_dim, int num_heads = 1);
+
+    // Função que realiza o forward pass sobre a sequência inteira (seq_len x model_dim):
+    // projeta Q, K e V de todas as posições, aplica softmax(Q K^T / sqrt(d)) por linha e multiplica por V.
+    // Com várias cabeças, cada uma trabalha na sua fatia de colunas em paralelo e as saídas concatenadas passam por W_o.
+    Tensor forward(const Tensor &input) const;
+
+    // Versão para um lote com padding ou empacotado (layout.rows() x model_dim): as projeções são GEMMs sobre o lote
+    // inteiro e cada exemplo atende apenas às posições do seu próprio segmento
+    Tensor forward(const Tensor &input, const BatchLayout &layout) const;
 
-    // Função que realiza o forward pass, computando a autoatenção (self-attention)
-    std::vector<double> forward(const std::vector<double> &input) const;
+    // Versão que escreve em output (layout.rows() x model_dim); Q, K, V e as cabeças ficam na arena e são devolvidos
+    // a ela no fim, então a chamada não aloca memória depois que a arena atinge o tamanho do lote
+    void forward(ConstTensorView input, const BatchLayout &layout, TensorView output, ActivationArena &arena) const;
     
-    // Função que multiplica uma matriz por um vetor, usada nos cálculos da atenção
-    std::vector<double> multiply(const std::vector<std::vector<double>>& matrix, const std::vector<double>& vector) const;
+    // Função que projeta todas as posições da sequência com uma matriz de pesos (input * matrix^T), usada nos cálculos da atenção
+    Tensor multiply(const Tensor &input, ConstTensorView matrix) const;
+
+    // Função forward que utiliza a atenção cruzada entre a entrada e os outputs do encoder:
+    // as queries vêm de input e as keys/values de encoder_input
+    Tensor forward(const Tensor &input, const Tensor &encoder_input) const;
+
+    // Atenção cruzada em lote: o exemplo b de input atende às posições do exemplo b de encoder_input
+    Tensor forward(const Tensor &input, const BatchLayout &layout, const Tensor &encoder_input, const BatchLayout &encoder_layout) const;
+
+    // Atenção cruzada em lote escrevendo em output, com os intermediários na arena
+    void forward(ConstTensorView input, const BatchLayout &layout, ConstTensorView encoder_input, const BatchLayout &encoder_layout,
+                 TensorView output, ActivationArena &arena) const;
+
+    // Atenção cruzada com as keys/values do encoder já projetadas por projectKeysValues
+    Tensor forward(const Tensor &input, const KVCache &memory) const;
+
+    // Função que projeta keys e values de uma sequência fixa (o output do encoder) uma única vez,
+    // para reaproveitá-las em todas as chamadas de cross-attention da mesma requisição
+    void projectKeysValues(ConstTensorView source, KVCache &memory) const;
+
+    // Função que computa as pontuações de atenção escaladas (Q K^T / sqrt(d)) entre todas as queries e keys
+    Tensor computeAttentionScores(ConstTensorView Q, ConstTensorView K) const;
+
+    // Função que quantiza W_q, W_k, W_v e W_o em INT8 (uma escala por canal de saída) e libera as versões em ponto flutuante.
+    // A partir daí as projeções usam o GEMM INT8; é um passo offline, feito uma vez antes da inferência.
+    void quantizeWeights();
+
+    // Funções que indicam se os pesos estão quantizados e retornam a memória ocupada por eles
+    bool isQuantized() const { return !W_q_int8.empty(); }
+    size_t weightBytes() const;
+
+    // Funções que salvam e carregam W_q, W_k, W_v (e W_o, com várias cabeças) como seções prefix.W_* de um checkpoint.
+    // Os pesos carregados apontam direto para o arquivo mapeado; pesos quantizados não podem ser salvos.
+    void saveParameters(CheckpointWriter &writer, const std::string &prefix) const;
+    void loadParameters(const CheckpointReader &reader, const std::string &prefix);
+
+    // Função que retorna o número de cabeças de atenção
+    int getNumHeads() const { return num_heads; }
+
+    // Funções que escolhem e retornam o kernel de atenção
+    void setKernel(AttentionKernel kernel) { this->kernel = kernel; }
+    AttentionKernel getKernel() const { return kernel; }
+
+    // Funções que ligam/desligam a máscara causal
+    void setCausal(bool causal) { this->causal = causal; }
+    bool isCausal() const { return causal; }
 
-    // Função forward que utiliza a atenção cruzada entre a entrada e os outputs do encoder
-    std::vector<double> forward(const std::vector<double> &input, const std::vector<std::vector<double>> &encoder_input) const;
+    // Função que processa apenas uma nova posição (input 1 x model_dim) na decodificação incremental:
+    // projeta q, k e v só dessa posição, acrescenta k e v ao cache e atende a todas as posições do cache.
+    // Usa apenas os buffers pré-alocados em cache e scratch, sem alocar memória.
+    void step(ConstTensorView input, KVCache &cache, AttentionScratch &scratch, TensorView output) const;
 
-    // Função que computa as pontuações de atenção (scores de atenção) entre Q e K
-    std::vector<double> computeAttentionScores(const std::vector<double>& Q, const std::vector<std::vector<double>>& K);
+    // Versão de step para cross-attention: projeta só a query e atende às keys/values fixas em memory,
+    // sem modificá-las (scratch precisa comportar memory.length scores)
+    void crossStep(ConstTensorView input, const KVCache &memory, AttentionScratch &scratch, TensorView output) const;
 
 };
 
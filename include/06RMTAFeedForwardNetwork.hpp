@@ -19,16 +19,52 @@
 // Inclui a biblioteca random
 #include <random>
 
+// Inclui o tipo Tensor, que guarda as matrizes de pesos em blocos contíguos
+#include "Tensor.hpp"
+
+// Inclui o GEMM usado nas transformações lineares
+#include "VectorOp.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar os pesos
+#include "Checkpoint.hpp"
+
 // Declaração da classe FeedForwardNetwork
 class FeedForwardNetwork {
 
 public:
 
-    // Construtor que inicializa apenas a dimensão do modelo
-    explicit FeedForwardNetwork(int model_dim);
+    // Construtor que inicializa a dimensão do modelo e a ativação da camada oculta (ReLU, GELU ou SwiGLU). Com SwiGLU,
+    // W1 tem 2 * hidden_dim linhas: a linha 2p é o gate e a 2p + 1 o up da feature p.
+    explicit FeedForwardNetwork(int model_dim, ActivationFunction activation = ActivationFunction::ReLU);
+
+    // Função que realiza o forward pass, processando todas as posições (seq_len x model_dim) pela rede feedforward
+    Tensor forward(const Tensor& input) const;
+
+    // Versão que escreve em buffers fornecidos pelo chamador (hidden: seq_len x getScratchDim(), output: seq_len x
+    // model_dim), sem alocar. Cada GEMM aplica o seu epílogo nos blocos que ficam prontos: bias e ativação no primeiro,
+    // bias e (se 'residual' não estiver vazia) a soma residual no segundo, sem passadas extras sobre as ativações.
+    void forward(ConstTensorView input, TensorView hidden, TensorView output, ConstTensorView residual = {}) const;
+
+    // Função que retorna a dimensão da camada oculta
+    int getHiddenDim() const { return hidden_dim; }
+
+    // Função que retorna as colunas do buffer 'hidden' do forward: hidden_dim, ou 3 * hidden_dim com SwiGLU (os pares
+    // gate/up antes da ativação e o resultado)
+    int getScratchDim() const { return activation == ActivationFunction::SwiGLU ? 3 * hidden_dim : hidden_dim; }
 
-    // Função que realiza o forward pass, processando os inputs pela rede feedforward
-    std::vector<double> forward(const std::vector<double>& input) const;
+    // Função que retorna a ativação da camada oculta
+    ActivationFunction getActivation() const { return activation; }
+
+    // Função que quantiza W1 e W2 em INT8 (uma escala por canal de saída) e libera as versões em ponto flutuante
+    void quantizeWeights();
+
+    // Funções que indicam se os pesos estão quantizados e retornam a memória ocupada por eles
+    bool isQuantized() const { return !W1_int8.empty(); }
+    size_t weightBytes() const;
+
+    // Funções que salvam e carregam W1, b1, W2 e b2 como seções prefix.* de um checkpoint
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const;
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix);
 
 private:
 
@@ -38,20 +74,24 @@ private:
     // Dimensão da camada oculta definida internamente
     const int hidden_dim = 4 * model_dim;  // Geralmente, hidden_dim é 4 vezes o model_dim nos transformers
 
+    // Ativação da camada oculta e número de linhas de W1 (2 * hidden_dim com SwiGLU)
+    ActivationFunction activation;
+    int w1_rows;
+
     // Pesos e vieses para a primeira transformação linear
-    std::vector<std::vector<double>> W1;
-    std::vector<double> b1;
+    Tensor W1;
+    std::vector<real_t> b1;
 
     // Pesos e vieses para a segunda transformação linear
-    std::vector<std::vector<double>> W2;
-    std::vector<double> b2;
+    Tensor W2;
+    std::vector<real_t> b2;
 
-    // Funções para inicializar os pesos com valores aleatórios
-    void initialize_weights(std::vector<std::vector<double>>& weights, int rows, int cols);
-    void initialize_bias(std::vector<double>& bias, int size);
+    // Versões INT8 de W1 e W2 (preenchidas por quantizeWeights)
+    QuantizedMatrix W1_int8, W2_int8;
 
-    // Função de ativação (ReLU neste caso)
-    std::vector<double> relu(const std::vector<double>& x) const;
+    // Funções para inicializar os pesos com valores aleatórios
+    void initialize_weights(Tensor& weights, int rows, int cols);
+    void initialize_bias(std::vector<real_t>& bias, int size);
 };
 
 #endif
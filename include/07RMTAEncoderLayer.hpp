@@ -30,11 +30,43 @@ class EncoderLayer {
 
 public:
     
-    // Construtor que inicializa a dimensão do modelo e configura os subcomponentes (self-attention, feedforward e layer norm)
-    EncoderLayer(int model_dim);
+    // Construtor que inicializa a dimensão do modelo e configura os subcomponentes (self-attention com num_heads cabeças, feedforward com a
+    // ativação 'activation' e layer norm)
+    EncoderLayer(int model_dim, int num_heads = 1, ActivationFunction activation = ActivationFunction::ReLU);
     
-    // Função que executa o forward pass da camada, recebendo os inputs e retornando os outputs processados
-    std::vector<std::vector<double>> forward(const std::vector<std::vector<double>>& inputs) ;
+    // Função que executa o forward pass da camada, recebendo os inputs (seq_len x model_dim) e retornando os outputs processados
+    Tensor forward(const Tensor& inputs) ;
+
+    // Versão para um lote de sequências com padding (layout.rows() x model_dim); a self-attention respeita o comprimento
+    // de cada sequência e as demais etapas processam o lote inteiro de uma vez
+    Tensor forward(const Tensor& inputs, const BatchLayout& layout);
+
+    // Versão que escreve em outputs (layout.rows() x model_dim), com as ativações intermediárias na arena
+    void forward(ConstTensorView inputs, const BatchLayout& layout, TensorView outputs, ActivationArena& arena);
+
+    // Função que escolhe o kernel usado na self-attention desta camada
+    void setAttentionKernel(AttentionKernel kernel) { selfAttention.setKernel(kernel); }
+
+    // Função que quantiza em INT8 os pesos da self-attention e da feedforward desta camada
+    void quantizeWeights() {
+        selfAttention.quantizeWeights();
+        feedForward.quantizeWeights();
+    }
+
+    // Função que retorna a memória ocupada pelos pesos da camada
+    size_t weightBytes() const { return selfAttention.weightBytes() + feedForward.weightBytes(); }
+
+    // Funções que salvam e carregam os parâmetros da camada (seções prefix.attention.*, prefix.ffn.* e prefix.norm.*)
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+        selfAttention.saveParameters(writer, prefix + ".attention");
+        feedForward.saveParameters(writer, prefix + ".ffn");
+        layerNorm.saveParameters(writer, prefix + ".norm");
+    }
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+        selfAttention.loadParameters(reader, prefix + ".attention");
+        feedForward.loadParameters(reader, prefix + ".ffn");
+        layerNorm.loadParameters(reader, prefix + ".norm");
+    }
 
 private:
     
@@ -46,9 +78,6 @@ private:
     
     // Normalização da camada para estabilizar o treinamento
     LayerNorm layerNorm;
-
-    // Função auxiliar que realiza a soma elemento a elemento entre dois vetores
-    std::vector<double> add(const std::vector<double>& a, const std::vector<double>& b) const;
 };
 
 // Encerra a definição condicional de ENCODERLAYER_H
@@ -18,11 +18,35 @@ class Encoder {
 
 public:
     
-    // Construtor que inicializa o número de camadas e a dimensão do modelo
-    Encoder(int num_layers, int model_dim);
+    // Construtor que inicializa o número de camadas, a dimensão do modelo, o número de cabeças de atenção e a ativação
+    // das redes feedforward
+    Encoder(int num_layers, int model_dim, int num_heads = 1, ActivationFunction activation = ActivationFunction::ReLU);
 
-    // Função que realiza o forward pass no encoder, recebendo um vetor de inputs e retornando o resultado
-    std::vector<std::vector<double>> forward(const std::vector<std::vector<double>>& inputs);
+    // Função que realiza o forward pass no encoder, recebendo a matriz de inputs (seq_len x model_dim) e retornando o resultado
+    Tensor forward(const Tensor& inputs);
+
+    // Versão para um lote de sequências com padding ([batch, seq, dim] guardado como layout.rows() x model_dim)
+    Tensor forward(const Tensor& inputs, const BatchLayout& layout);
+
+    // Versão que escreve em outputs, alternando as ativações entre dois buffers da arena de camada em camada
+    void forward(ConstTensorView inputs, const BatchLayout& layout, TensorView outputs, ActivationArena& arena);
+
+    // Número de camadas e forward de uma única camada, para quem distribui as camadas entre threads (LayerPipeline)
+    size_t numLayers() const;
+    Tensor forwardLayer(size_t index, const Tensor& inputs, const BatchLayout& layout);
+
+    // Função que escolhe o kernel de atenção em todas as camadas
+    void setAttentionKernel(AttentionKernel kernel);
+
+    // Função que quantiza em INT8 os pesos de todas as camadas (passo offline, antes da inferência)
+    void quantizeWeights();
+
+    // Função que retorna a memória ocupada pelos pesos de todas as camadas
+    size_t weightBytes() const;
+
+    // Funções que salvam e carregam os parâmetros de todas as camadas (seções prefix.layers.<i>.*)
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const;
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix);
 
 private:
     
@@ -19,28 +19,101 @@
 // Inclui o cabeçalho da classe FeedForwardNetwork, usada para processar os embeddings após as atenções
 #include "06RMTAFeedForwardNetwork.hpp"
 
+// Estado de uma camada do decoder durante a decodificação incremental (pré-alocado para até max_seq_len posições)
+struct DecoderLayerState {
+
+    // Cache de keys/values da self-attention e buffers do passo de atenção
+    KVCache selfCache;
+    AttentionScratch scratch;
+
+    // Keys/values do output do encoder, projetadas uma única vez por requisição, e buffers da cross-attention
+    KVCache crossCache;
+    AttentionScratch crossScratch;
+
+    // Ativações da posição atual (1 x model_dim) e camada oculta da feedforward (1 x hidden_dim)
+    Tensor selfAttnOutput, addNorm1, encDecAttnOutput, addNorm2, hidden, ffOutput;
+};
+
 // Declaração da classe DecoderLayer, que representa uma camada do decoder em uma arquitetura Transformer
 class DecoderLayer {
 
 public:
 
-    // Construtor que inicializa as subcamadas: duas Self-Attention, uma FeedForward e três LayerNorm
-    DecoderLayer(int model_dim) : 
-        selfAttention(model_dim),   // Atenção interna do decoder (self-attention)
-        encDecAttention(model_dim), // Atenção entre encoder e decoder (cross-attention)
-        feedForward(model_dim),     // Rede feedforward para processamento posterior
+    // Construtor que inicializa as subcamadas: duas Self-Attention, uma FeedForward (com a ativação 'activation') e três LayerNorm
+    DecoderLayer(int model_dim, int num_heads = 1, ActivationFunction activation = ActivationFunction::ReLU) : 
+        model_dim(model_dim),
+        selfAttention(model_dim, num_heads),   // Atenção interna do decoder (self-attention)
+        encDecAttention(model_dim, num_heads), // Atenção entre encoder e decoder (cross-attention)
+        feedForward(model_dim, activation), // Rede feedforward para processamento posterior
         layerNorm1(model_dim),      // Normalização após self-attention
         layerNorm2(model_dim),      // Normalização após encoder-decoder attention
         layerNorm3(model_dim)       // Normalização após a feedforward network
-    {}
+    {
+        // A self-attention do decoder é causal: cada posição só enxerga as anteriores, como na geração token a token
+        selfAttention.setCausal(true);
+    }
 
     // Função que realiza o forward pass na camada do decoder, processando as entradas do decoder e os outputs do encoder
-    std::vector<std::vector<double>> forward(const std::vector<std::vector<double>>& decoderInput, const std::vector<std::vector<double>>& encoderOutput);
+    Tensor forward(const Tensor& decoderInput, const Tensor& encoderOutput);
+
+    // Versão para lotes: a sequência b do decoder (layout) usa só as suas posições válidas na self-attention e só as
+    // posições válidas da sequência b do encoder (encoderLayout) na cross-attention
+    Tensor forward(const Tensor& decoderInput, const BatchLayout& layout, const Tensor& encoderOutput, const BatchLayout& encoderLayout);
+
+    // Versão que escreve em output (layout.rows() x model_dim), com as ativações intermediárias na arena
+    void forward(ConstTensorView decoderInput, const BatchLayout& layout, ConstTensorView encoderOutput, const BatchLayout& encoderLayout,
+                 TensorView output, ActivationArena& arena);
     
     // Função que realiza o backward pass, calculando os gradientes para as entradas do decoder e os outputs do encoder
-    std::vector<std::vector<double>> backward(const std::vector<std::vector<double>>& dL_dOutputs, const std::vector<std::vector<double>>& encoderOutputs);
+    Tensor backward(const Tensor& dL_dOutputs, const Tensor& encoderOutputs);
+
+    // Função que prepara o estado de decodificação incremental desta camada para até max_seq_len posições,
+    // projetando as keys/values da cross-attention sobre o output do encoder
+    void initState(DecoderLayerState& state, size_t max_seq_len, const Tensor& encoderOutput) const;
+
+    // Função que processa apenas uma nova posição (input e output 1 x model_dim), usando e atualizando os caches em state.
+    // Não aloca memória: todas as ativações ficam nos buffers de state.
+    void step(DecoderLayerState& state, ConstTensorView input, TensorView output) const;
+
+    // Função que escolhe o kernel usado nas duas atenções desta camada
+    void setAttentionKernel(AttentionKernel kernel) {
+        selfAttention.setKernel(kernel);
+        encDecAttention.setKernel(kernel);
+    }
+
+    // Função que quantiza em INT8 os pesos das duas atenções e da feedforward desta camada
+    void quantizeWeights() {
+        selfAttention.quantizeWeights();
+        encDecAttention.quantizeWeights();
+        feedForward.quantizeWeights();
+    }
+
+    // Função que retorna a memória ocupada pelos pesos da camada
+    size_t weightBytes() const { return selfAttention.weightBytes() + encDecAttention.weightBytes() + feedForward.weightBytes(); }
+
+    // Funções que salvam e carregam os parâmetros da camada (seções prefix.self_attention.*, prefix.cross_attention.*,
+    // prefix.ffn.* e prefix.norm1/2/3.*)
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+        selfAttention.saveParameters(writer, prefix + ".self_attention");
+        encDecAttention.saveParameters(writer, prefix + ".cross_attention");
+        feedForward.saveParameters(writer, prefix + ".ffn");
+        layerNorm1.saveParameters(writer, prefix + ".norm1");
+        layerNorm2.saveParameters(writer, prefix + ".norm2");
+        layerNorm3.saveParameters(writer, prefix + ".norm3");
+    }
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+        selfAttention.loadParameters(reader, prefix + ".self_attention");
+        encDecAttention.loadParameters(reader, prefix + ".cross_attention");
+        feedForward.loadParameters(reader, prefix + ".ffn");
+        layerNorm1.loadParameters(reader, prefix + ".norm1");
+        layerNorm2.loadParameters(reader, prefix + ".norm2");
+        layerNorm3.loadParameters(reader, prefix + ".norm3");
+    }
 
 private:
+
+    // Dimensão do modelo (tamanho da representação de cada token)
+    int model_dim;
     
     // Instância de self-attention, usada para processar as dependências dentro da sequência do decoder
     SelfAttention selfAttention;
@@ -53,17 +126,6 @@ private:
     
     // Três normalizações de camada: uma após self-attention, outra após cross-attention e uma após feedforward
     LayerNorm layerNorm1, layerNorm2, layerNorm3;
-
-    // Função auxiliar que realiza a soma de dois vetores, elemento a elemento
-    std::vector<double> add(const std::vector<double>& a, const std::vector<double>& b) const {
-        std::vector<double> result(a.size());
-        
-        // Soma cada elemento de 'a' com o correspondente em 'b'
-        for (size_t i = 0; i < a.size(); ++i) {
-            result[i] = a[i] + b[i];
-        }
-        return result;
-    }
 };
 
 #endif
@@ -12,20 +12,92 @@
 // Inclui o cabeçalho da classe DecoderLayer, que será usada na construção do Decoder
 #include "09RMTADecoderLayer.hpp"
 
+// Inclui std::span
+#include <span>
+
+// Sessão de decodificação incremental: guarda o cache de keys/values de cada camada e os buffers de um passo.
+// Toda a memória é reservada em Decoder::startSession; os passos seguintes não alocam.
+class DecoderSession {
+
+public:
+
+    // Número de posições já processadas
+    size_t position() const { return length; }
+
+    // Número máximo de posições da sessão
+    size_t capacity() const { return max_seq_len; }
+
+    // Recomeça a sequência mantendo os buffers e as keys/values do encoder
+    void reset() {
+        for (auto& layer : layers) {
+            layer.selfCache.clear();
+        }
+        length = 0;
+    }
+
+private:
+
+    friend class Decoder;
+
+    // Estado de cada camada do decoder
+    std::vector<DecoderLayerState> layers;
+
+    // Buffers de entrada e saída de uma camada (1 x model_dim), trocados a cada camada
+    Tensor current, next;
+
+    // Posições processadas e limite da sessão
+    size_t length = 0;
+    size_t max_seq_len = 0;
+};
+
 // Declaração da classe Decoder, responsável pela parte do decoder em uma arquitetura Transformer
 class Decoder
 {
 
 public:
     
-    // Construtor que inicializa o número de camadas e a dimensão do modelo
-    Decoder(int num_layers, int model_dim);
+    // Construtor que inicializa o número de camadas, a dimensão do modelo, o número de cabeças de atenção e a ativação
+    // das redes feedforward
+    Decoder(int num_layers, int model_dim, int num_heads = 1, ActivationFunction activation = ActivationFunction::ReLU);
 
     // Função que realiza o forward pass no decoder, recebendo as entradas e as saídas do encoder
-    std::vector<std::vector<double>> *forward(const std::vector<std::vector<double>> &input, const std::vector<std::vector<double>> &encoderOutput);
+    Tensor *forward(const Tensor &input, const Tensor &encoderOutput);
+
+    // Versão para um lote de sequências com padding: 'layout' descreve o lote de input e 'encoderLayout' o de encoderOutput
+    Tensor *forward(const Tensor &input, const BatchLayout &layout, const Tensor &encoderOutput, const BatchLayout &encoderLayout);
+
+    // Versão que escreve em output, alternando as ativações entre dois buffers da arena de camada em camada
+    void forward(ConstTensorView input, const BatchLayout &layout, ConstTensorView encoderOutput, const BatchLayout &encoderLayout,
+                 TensorView output, ActivationArena &arena);
+
+    // Número de camadas e forward de uma única camada, para quem distribui as camadas entre threads (LayerPipeline)
+    size_t numLayers() const;
+    Tensor forwardLayer(size_t index, const Tensor &input, const BatchLayout &layout, const Tensor &encoderOutput, const BatchLayout &encoderLayout);
     
     // Função que realiza o backward pass no decoder, propagando os gradientes
-    void backward(const std::vector<std::vector<double>> &dL_dDecoderOutputs, const std::vector<std::vector<double>> &encoderOutputs);
+    void backward(const Tensor &dL_dDecoderOutputs, const Tensor &encoderOutputs);
+
+    // Função que inicia uma sessão de decodificação incremental para até max_seq_len posições.
+    // As keys/values da cross-attention de cada camada são projetadas aqui, uma única vez por requisição.
+    DecoderSession startSession(const Tensor &encoderOutput, size_t max_seq_len) const;
+
+    // Função que processa a próxima posição da sessão: recebe o vetor já com embedding e codificação posicional
+    // e retorna a saída do decoder para essa posição (válida até o próximo passo). Equivale à última linha de
+    // forward() sobre toda a sequência até aqui, mas reaproveita as keys/values das posições anteriores.
+    std::span<const real_t> step(DecoderSession &session, std::span<const real_t> input) const;
+
+    // Função que escolhe o kernel de atenção em todas as camadas
+    void setAttentionKernel(AttentionKernel kernel);
+
+    // Função que quantiza em INT8 os pesos de todas as camadas (passo offline, antes da inferência)
+    void quantizeWeights();
+
+    // Função que retorna a memória ocupada pelos pesos de todas as camadas
+    size_t weightBytes() const;
+
+    // Funções que salvam e carregam os parâmetros de todas as camadas (seções prefix.layers.<i>.*)
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const;
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix);
 
 private:
     
@@ -0,0 +1,98 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se ACTIVATION_ARENA_H já foi definido, para evitar múltiplas inclusões
+#ifndef ACTIVATION_ARENA_H
+
+// Define ACTIVATION_ARENA_H se ainda não tiver sido definido
+#define ACTIVATION_ARENA_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui o tipo Tensor, o alocador alinhado e as views
+#include "Tensor.hpp"
+
+// Declaração da classe ActivationArena, um alocador por incremento (bump) para as ativações de um forward pass.
+//
+// allocate() só avança um deslocamento dentro de blocos alinhados que a arena mantém, então pedir uma matriz não
+// chama malloc. A memória é devolvida em pilha: Scope guarda a posição atual e a restaura ao sair (o que foi pedido
+// dentro dele volta a ficar livre), e reset() libera tudo entre duas requisições. Quando um forward precisa de mais
+// que a capacidade, a arena acrescenta um bloco; os blocos nunca mudam de lugar enquanto estão em uso, e reset()
+// junta todos em um único bloco do tamanho total. Depois do primeiro forward de cada tamanho, os seguintes não
+// alocam nada.
+//
+// Uma arena não é thread-safe: cada thread usa a sua (local() é a arena da thread atual, para temporários dentro de
+// tarefas paralelas).
+class ActivationArena {
+
+public:
+
+    // Posição da arena, usada para devolver de uma vez tudo o que foi pedido depois dela
+    struct Mark {
+        std::size_t block = 0;
+        std::size_t offset = 0;
+    };
+
+    // Devolve ao sair do escopo tudo o que foi pedido à arena dentro dele
+    class Scope {
+
+    public:
+
+        explicit Scope(ActivationArena& arena) : arena(arena), start(arena.mark()) {}
+        ~Scope() { arena.release(start); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+
+        ActivationArena& arena;
+        Mark start;
+    };
+
+    // Construtor que reserva 'initial_capacity' valores de início (0 reserva no primeiro pedido)
+    explicit ActivationArena(std::size_t initial_capacity = 0);
+
+    // A arena não pode ser copiada (as views entregues apontam para os seus blocos)
+    ActivationArena(const ActivationArena&) = delete;
+    ActivationArena& operator=(const ActivationArena&) = delete;
+
+    // Retorna uma matriz rows x cols contígua, alinhada em TENSOR_ALIGNMENT bytes e sem inicialização
+    TensorView allocate(std::size_t rows, std::size_t cols);
+
+    // Posição atual e devolução de tudo o que foi pedido depois de 'mark'
+    Mark mark() const;
+    void release(Mark mark);
+
+    // Devolve tudo (nenhuma view entregue pode continuar em uso) e junta os blocos em um só
+    void reset();
+
+    // Valores reservados em todos os blocos, maior uso já registrado e quantas vezes a arena alocou memória
+    std::size_t capacity() const;
+    std::size_t peak() const { return peak_used; }
+    std::size_t heapAllocations() const { return heap_allocations; }
+
+    // Arena da thread atual, para temporários com Scope (por exemplo, os scores de uma cabeça de atenção)
+    static ActivationArena& local();
+
+private:
+
+    // Acrescenta (ou reaproveita) um bloco com pelo menos 'values' valores depois do bloco atual
+    void advanceBlock(std::size_t values);
+
+    // Blocos alinhados, bloco atual e deslocamento dentro dele
+    std::vector<std::vector<real_t, AlignedAllocator<real_t>>> blocks;
+    std::size_t current = 0;
+    std::size_t offset = 0;
+
+    // Valores em uso nos blocos anteriores ao atual, maior uso e número de alocações
+    std::size_t used_before = 0;
+    std::size_t peak_used = 0;
+    std::size_t heap_allocations = 0;
+};
+
+#endif
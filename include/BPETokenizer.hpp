@@ -0,0 +1,97 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se BPE_TOKENIZER_H já foi definido, para evitar múltiplas inclusões
+#ifndef BPE_TOKENIZER_H
+
+// Define BPE_TOKENIZER_H se ainda não tiver sido definido
+#define BPE_TOKENIZER_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui std::string_view
+#include <string_view>
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui a biblioteca padrão de mapas não ordenados (hash map)
+#include <unordered_map>
+
+// Inclui os inteiros de tamanho fixo
+#include <cstdint>
+
+// Inclui std::span
+#include <span>
+
+// Número de tokens de byte: os IDs 0..255 representam os bytes individuais
+constexpr int BPE_BYTE_TOKENS = 256;
+
+// Declaração da classe BPETokenizer, um tokenizador de subpalavras BPE em nível de byte.
+//
+// O vocabulário é fixo depois do treino: IDs 0..255 são os bytes, em seguida vêm os tokens especiais (por exemplo
+// "<end>") e depois um token por regra de fusão, na ordem em que foram aprendidas. Qualquer texto é representável
+// (no pior caso, byte a byte), então não existe token desconhecido e detokenize(tokenize(texto)) == texto.
+//
+// O texto é pré-dividido em pedaços "espaços + palavra" (os espaços ficam grudados no início da palavra seguinte)
+// e as fusões nunca atravessam pedaços. Um pedaço cuja palavra é exatamente um token especial vira o ID especial.
+class BPETokenizer {
+
+public:
+
+    // Treina o vocabulário sobre as linhas de 'corpus' até 'vocab_size' tokens (bytes + especiais + fusões),
+    // parando antes se nenhum par aparecer pelo menos 'min_frequency' vezes
+    static BPETokenizer train(const std::vector<std::string>& corpus, int vocab_size,
+                              const std::vector<std::string>& special_tokens = {}, int min_frequency = 2);
+
+    // Converte um texto em IDs de tokens (não modifica o vocabulário)
+    std::vector<int> tokenize(std::string_view text) const;
+
+    // Converte IDs de tokens de volta para o texto (concatenação dos bytes de cada token)
+    std::string detokenize(std::span<const int> tokens) const;
+
+    // Retorna o tamanho do vocabulário
+    int getVocabSize() const { return static_cast<int>(token_bytes.size()); }
+
+    // Retorna o ID de um token especial, ou -1 se ele não existir
+    int specialTokenId(std::string_view token) const;
+
+    // Retorna os bytes de um token
+    const std::string& tokenBytes(int token_id) const { return token_bytes[token_id]; }
+
+    // Serializa o vocabulário: [uint32 special_count][uint32 offsets[special_count + 1]][caracteres dos especiais]
+    // [uint32 merge_count][pares (uint32 esquerda, uint32 direita) x merge_count]
+    std::vector<char> serialize() const;
+
+    // Reconstrói o vocabulário serializado por serialize (lança std::runtime_error se os dados forem inválidos)
+    static BPETokenizer deserialize(std::span<const char> bytes);
+
+private:
+
+    // Par de tokens adjacentes (esquerda, direita) codificado em 64 bits
+    static uint64_t pairKey(int left, int right) { return (uint64_t(uint32_t(left)) << 32) | uint32_t(right); }
+
+    // Tokens especiais, na ordem dos IDs (o primeiro tem ID BPE_BYTE_TOKENS)
+    std::vector<std::string> special_tokens;
+
+    // Regras de fusão, na ordem de prioridade (a fusão r produz o token firstMergeId() + r)
+    std::vector<std::pair<int, int>> merges;
+
+    // Tabela de ranks: par -> posição da fusão em 'merges' (menor = aplicada primeiro)
+    std::unordered_map<uint64_t, int> merge_ranks;
+
+    // Bytes de cada token, indexados pelo ID
+    std::vector<std::string> token_bytes;
+
+    // ID do primeiro token produzido por fusão
+    int firstMergeId() const { return BPE_BYTE_TOKENS + static_cast<int>(special_tokens.size()); }
+
+    // Reconstrói merge_ranks e token_bytes a partir de special_tokens e merges
+    void rebuildTables();
+
+    // Aplica as fusões a um pedaço de texto, acrescentando os IDs resultantes em 'output'
+    void encodeChunk(std::string_view chunk, std::vector<int>& output) const;
+};
+
+#endif
@@ -0,0 +1,94 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se BATCH_LAYOUT_H já foi definido, para evitar múltiplas inclusões
+#ifndef BATCH_LAYOUT_H
+
+// Define BATCH_LAYOUT_H se ainda não tiver sido definido
+#define BATCH_LAYOUT_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui o tipo Tensor
+#include "Tensor.hpp"
+
+// Disposição de um lote de sequências de comprimentos diferentes em um único Tensor [batch, seq, dim].
+//
+// O lote é guardado como uma matriz de batch_size * max_len linhas. Cada exemplo ocupa um segmento de linhas
+// consecutivas dentro de uma das batch_size sequências; as linhas que não pertencem a nenhum segmento são padding.
+//   - Lote com padding (fromLengths): um exemplo por sequência, o exemplo i nas linhas [i * max_len, i * max_len + n_i).
+//   - Lote empacotado (pack): vários exemplos curtos dividem a mesma sequência, um após o outro, quase sem padding.
+// As operações por posição (projeções, feedforward, LayerNorm, camada final) tratam o lote inteiro como uma
+// única matriz, com GEMMs grandes. A atenção é calculada segmento a segmento (máscara bloco-diagonal: um exemplo
+// nunca enxerga posições de outro nem o padding) e a perda usa apenas as linhas de cada segmento.
+struct BatchLayout {
+
+    // Linhas de um exemplo dentro da matriz do lote: [offset, offset + length)
+    struct Segment {
+        size_t offset;
+        size_t length;
+    };
+
+    // Posições de cada sequência do lote, número de sequências e segmento de cada exemplo (na ordem dos exemplos)
+    size_t max_len = 0;
+    size_t batch_size = 0;
+    std::vector<Segment> segments;
+
+    // Lote com uma única sequência, sem padding
+    static BatchLayout single(size_t length) { return BatchLayout{length, 1, {Segment{0, length}}}; }
+
+    // Lote com um exemplo por sequência, completadas com padding até a maior delas
+    static BatchLayout fromLengths(const std::vector<size_t>& lengths);
+
+    // Lote empacotado: os exemplos são distribuídos em sequências de seq_len posições (ou do comprimento do maior
+    // exemplo, se ele não couber), do maior para o menor, cada um na primeira sequência com espaço (first-fit decreasing)
+    static BatchLayout pack(const std::vector<size_t>& lengths, size_t seq_len);
+
+    // Número de exemplos, de linhas da matriz e de posições válidas (sem padding)
+    size_t size() const { return segments.size(); }
+    size_t rows() const { return batch_size * max_len; }
+    size_t tokens() const {
+        size_t total = 0;
+        for (const Segment& segment : segments) {
+            total += segment.length;
+        }
+        return total;
+    }
+
+    // Primeira linha e comprimento do exemplo i
+    size_t offset(size_t i) const { return segments[i].offset; }
+    size_t length(size_t i) const { return segments[i].length; }
+
+    // Linhas do exemplo i dentro da matriz do lote (sem cópia)
+    ConstTensorView sequence(ConstTensorView batch, size_t i) const { return batch.rowRange(offset(i), length(i)); }
+
+    // Monta a matriz do lote copiando cada exemplo (sequences[i] com length(i) linhas) para o seu segmento;
+    // o padding fica zerado
+    Tensor pad(const std::vector<ConstTensorView>& sequences) const;
+};
+
+// Contadores de padding dos lotes processados
+struct PaddingStats {
+
+    // Lotes e exemplos processados
+    size_t batches = 0;
+    size_t sequences = 0;
+
+    // Posições válidas e posições processadas (válidas + padding) somadas em todos os lotes
+    size_t tokens = 0;
+    size_t padded_tokens = 0;
+
+    // Acrescenta um lote aos contadores
+    void add(const BatchLayout& layout) {
+        batches += 1;
+        sequences += layout.size();
+        tokens += layout.tokens();
+        padded_tokens += layout.rows();
+    }
+
+    // Fração das posições processadas que não são padding
+    double efficiency() const { return padded_tokens == 0 ? 1.0 : double(tokens) / padded_tokens; }
+};
+
+#endif
@@ -0,0 +1,74 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se BATCH_SCHEDULER_H já foi definido, para evitar múltiplas inclusões
+#ifndef BATCH_SCHEDULER_H
+
+// Define BATCH_SCHEDULER_H se ainda não tiver sido definido
+#define BATCH_SCHEDULER_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui std::map, que mantém os buckets ordenados por comprimento
+#include <map>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui o stream do dataset, de onde vêm os exemplos
+#include "DatasetStream.hpp"
+
+// Declaração da classe BatchScheduler, que agrupa os exemplos de um DatasetStream em lotes por comprimento.
+//
+// Cada exemplo vai para o bucket do comprimento da sua entrada codificada, que é o que ele ocupa no lote (comprimentos
+// 1..w no bucket 0, w+1..2w no bucket 1, etc., com w = bucket_width), então as sequências de um lote diferem em menos
+// de w posições e o padding fica pequeno.
+// O tamanho do lote é limitado por um orçamento de posições (sequências x maior comprimento, padding incluído) em vez
+// de um número fixo de sequências: lotes de sequências curtas levam muitos exemplos e lotes de sequências longas
+// levam poucos, com custo parecido. Um bucket é emitido quando o próximo exemplo estouraria o orçamento; no fim do
+// stream, os buckets restantes são emitidos do mais curto ao mais longo.
+//
+// No modo empacotado (lotes montados com BatchLayout::pack), o padding deixa de depender do comprimento dos vizinhos:
+// todos os exemplos vão para um único bucket e o orçamento passa a limitar a soma dos comprimentos.
+class BatchScheduler {
+
+public:
+
+    // Construtor que define o orçamento de posições por lote, a largura dos buckets (ambos no mínimo 1) e o modo
+    BatchScheduler(std::size_t token_budget, std::size_t bucket_width, bool packed = false);
+
+    // Preenche 'batch' com o próximo lote, lendo do stream quantos exemplos forem necessários.
+    // Retorna false quando o stream acabou e todos os buckets foram esvaziados.
+    bool next(DatasetStream& stream, std::vector<Example>& batch);
+
+private:
+
+    // Posições que o exemplo ocupa no lote (linhas de encoded_input, ou o número de tokens se não foi preparado)
+    static std::size_t encodedLength(const Example& example);
+
+    // Exemplos à espera em um bucket, o maior comprimento e a soma dos comprimentos
+    struct Bucket {
+        std::vector<Example> examples;
+        std::size_t max_len = 0;
+        std::size_t tokens = 0;
+    };
+
+    // Posições ocupadas por um lote de 'count' exemplos, o maior com 'max_len' posições e 'tokens' posições ao todo
+    std::size_t positions(std::size_t count, std::size_t max_len, std::size_t tokens) const {
+        return packed ? tokens : count * max_len;
+    }
+
+    // Move os exemplos do bucket para 'batch' e esvazia o bucket
+    void emit(Bucket& bucket, std::vector<Example>& batch);
+
+    // Orçamento de posições por lote, largura dos buckets e modo empacotado
+    std::size_t token_budget;
+    std::size_t bucket_width;
+    bool packed;
+
+    // Buckets indexados por (comprimento - 1) / bucket_width (apenas o bucket 0 no modo empacotado)
+    std::map<std::size_t, Bucket> buckets;
+};
+
+#endif
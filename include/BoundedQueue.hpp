@@ -0,0 +1,84 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se BOUNDED_QUEUE_H já foi definido, para evitar múltiplas inclusões
+#ifndef BOUNDED_QUEUE_H
+
+// Define BOUNDED_QUEUE_H se ainda não tiver sido definido
+#define BOUNDED_QUEUE_H
+
+// Inclui mutex e variáveis de condição para a espera entre produtor e consumidor
+#include <mutex>
+#include <condition_variable>
+
+// Inclui a fila de itens
+#include <deque>
+
+// Inclui std::move
+#include <utility>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Declaração da classe BoundedQueue, uma fila bloqueante de capacidade fixa entre threads produtoras e consumidoras.
+// push espera enquanto a fila está cheia e pop espera enquanto ela está vazia, então um produtor nunca fica mais de
+// 'capacity' itens à frente do consumidor. close() acorda todos: push passa a falhar e pop esvazia o que sobrou.
+template <typename T>
+class BoundedQueue {
+
+public:
+
+    // Construtor que define quantos itens podem esperar na fila (no mínimo 1)
+    explicit BoundedQueue(std::size_t capacity) : capacity(capacity > 0 ? capacity : 1) {}
+
+    // A fila não pode ser copiada
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // Insere um item, esperando por espaço; retorna false (sem inserir) se a fila foi fechada
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Retira o próximo item, esperando se a fila estiver vazia; retorna false quando ela foi fechada e esvaziada
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Fecha a fila: nenhum item novo é aceito e as threads bloqueadas são acordadas
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        not_full.notify_all();
+        not_empty.notify_all();
+    }
+
+private:
+
+    // Itens em espera, protegidos por 'mutex'
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable not_full;
+    std::condition_variable not_empty;
+
+    // Capacidade máxima e sinal de encerramento
+    std::size_t capacity;
+    bool closed = false;
+};
+
+#endif
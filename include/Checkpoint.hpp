@@ -0,0 +1,151 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se CHECKPOINT_H já foi definido, para evitar múltiplas inclusões
+#ifndef CHECKPOINT_H
+
+// Define CHECKPOINT_H se ainda não tiver sido definido
+#define CHECKPOINT_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui o índice de seções por nome
+#include <unordered_map>
+
+// Inclui os inteiros de tamanho fixo
+#include <cstdint>
+
+// Inclui std::span
+#include <span>
+
+// Inclui o tipo Tensor
+#include "Tensor.hpp"
+
+// Inclui o mapeamento de arquivos em memória
+#include "MappedFile.hpp"
+
+// Formato binário de checkpoint (versão CHECKPOINT_VERSION, inteiros little-endian):
+//
+//   [CheckpointHeader, 64 bytes][CheckpointSection x section_count][dados das seções]
+//
+// Cada seção começa em um deslocamento múltiplo de CHECKPOINT_ALIGNMENT, então um tensor salvo no mesmo tipo
+// escalar do programa pode ser usado direto do arquivo mapeado, sem cópia (ver CheckpointReader::tensor).
+
+// Identificação do arquivo e versão do formato
+constexpr char CHECKPOINT_MAGIC[8] = {'B', 'B', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+// Alinhamento (em bytes) do início de cada seção
+constexpr std::size_t CHECKPOINT_ALIGNMENT = TENSOR_ALIGNMENT;
+
+// Tamanho máximo do nome de uma seção (incluindo o '\0')
+constexpr std::size_t CHECKPOINT_NAME_SIZE = 64;
+
+// Tipo dos elementos de uma seção
+enum class CheckpointDType : uint32_t {
+    Bytes = 0,
+    Float32 = 1,
+    Float64 = 2,
+    Int32 = 3,
+    UInt64 = 4
+};
+
+// Cabeçalho do arquivo
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t section_table_offset;
+    uint64_t file_size;
+    uint8_t reserved[32];
+};
+static_assert(sizeof(CheckpointHeader) == 64, "CheckpointHeader deve ter 64 bytes");
+
+// Entrada da tabela de seções
+struct CheckpointSection {
+    char name[CHECKPOINT_NAME_SIZE];
+    CheckpointDType dtype;
+    uint32_t reserved;
+    uint64_t rows, cols;
+    uint64_t offset, bytes;
+};
+
+// Declaração da classe CheckpointWriter, que monta e grava um checkpoint.
+// Os tensores não são copiados ao serem adicionados: precisam continuar vivos até write().
+class CheckpointWriter {
+
+public:
+
+    // Adiciona uma matriz (no tipo escalar do modelo)
+    void addTensor(const std::string& name, ConstTensorView tensor);
+
+    // Adiciona um vetor (gravado como uma matriz 1 x n)
+    void addVector(const std::string& name, std::span<const real_t> values);
+
+    // Adiciona uma seção de bytes arbitrários (copiados)
+    void addBytes(const std::string& name, std::vector<char> bytes);
+
+    // Adicionam arrays de inteiros (não copiados: precisam continuar vivos até write())
+    void addArray(const std::string& name, std::span<const int32_t> values);
+    void addArray(const std::string& name, std::span<const uint64_t> values);
+
+    // Grava o checkpoint em 'path' (lança std::runtime_error em caso de falha)
+    void write(const std::string& path) const;
+
+private:
+
+    // Seção pendente: uma view sobre os dados do modelo, bytes próprios ou um array emprestado
+    struct Entry {
+        std::string name;
+        CheckpointDType dtype;
+        ConstTensorView view;
+        std::vector<char> bytes;
+        std::span<const char> array;
+    };
+
+    // Valida o nome e registra a seção
+    void add(Entry entry);
+    std::vector<Entry> entries;
+};
+
+// Declaração da classe CheckpointReader, que mapeia um checkpoint com mmap e dá acesso às seções
+class CheckpointReader {
+
+public:
+
+    // Mapeia e valida o checkpoint (lança std::runtime_error se o arquivo for inválido)
+    explicit CheckpointReader(const std::string& path);
+
+    // Indica se existe uma seção com esse nome
+    bool contains(const std::string& name) const;
+
+    // Retorna a matriz 'name', que deve ter 'rows' x 'cols' elementos. Se foi salva no mesmo tipo escalar do
+    // programa, o tensor aponta direto para o arquivo mapeado (sem cópia); caso contrário, é convertido.
+    Tensor tensor(const std::string& name, std::size_t rows, std::size_t cols) const;
+
+    // Retorna o vetor 'name' (1 x size), copiado
+    std::vector<real_t> vector(const std::string& name, std::size_t size) const;
+
+    // Retorna os bytes da seção 'name' (válidos enquanto o leitor ou algum tensor emprestado existir)
+    std::span<const char> bytes(const std::string& name) const;
+
+    // Retornam arrays de inteiros direto do arquivo mapeado (mesma validade de bytes)
+    std::span<const int32_t> int32Array(const std::string& name) const;
+    std::span<const uint64_t> uint64Array(const std::string& name) const;
+
+private:
+
+    // Procura uma seção (lança std::runtime_error se não existir)
+    const CheckpointSection& find(const std::string& name) const;
+
+    // Arquivo mapeado e índice das seções por nome
+    std::shared_ptr<MappedFile> file;
+    const CheckpointSection* sections = nullptr;
+    std::unordered_map<std::string, std::size_t> index;
+};
+
+#endif
@@ -0,0 +1,34 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se CPU_FEATURES_H já foi definido, para evitar múltiplas inclusões
+#ifndef CPU_FEATURES_H
+
+// Define CPU_FEATURES_H se ainda não tiver sido definido
+#define CPU_FEATURES_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Declaração da estrutura CpuFeatures, que descreve as extensões SIMD disponíveis no processador
+struct CpuFeatures {
+
+    // Extensões detectadas via CPUID (e habilitadas pelo sistema operacional via XGETBV)
+    bool sse2 = false;
+    bool avx = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512vl = false;
+    bool avx512vnni = false;
+    bool avxvnni = false;
+
+    // Retorna as extensões do processador atual (detectadas uma única vez)
+    static const CpuFeatures& get();
+
+    // Lista as extensões detectadas, para exibição no console
+    std::string describe() const;
+};
+
+#endif
@@ -0,0 +1,73 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se DATASET_CACHE_H já foi definido, para evitar múltiplas inclusões
+#ifndef DATASET_CACHE_H
+
+// Define DATASET_CACHE_H se ainda não tiver sido definido
+#define DATASET_CACHE_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui std::span
+#include <span>
+
+// Inclui os inteiros de tamanho fixo
+#include <cstdint>
+
+// Inclui o tokenizador, cujo vocabulário é gravado junto com o dataset
+#include "02RMTATokenizer.hpp"
+
+// Inclui o corpus tokenizado
+#include "TokenizedCorpus.hpp"
+
+// Inclui o formato de checkpoint, usado como contêiner do cache
+#include "Checkpoint.hpp"
+
+// Declaração da classe DatasetCache, um dataset de pares (entrada, saída) já tokenizado e mapeado em memória.
+//
+// O arquivo é um checkpoint (mesmo contêiner de seções alinhadas) com:
+//   - o vocabulário do tokenizador ("tokenizer.vocab" ou "tokenizer.bpe"), para que os IDs tenham significado;
+//   - "dataset.info": [número de pares, tamanho do vocabulário];
+//   - "dataset.offsets": 2 * pares + 1 deslocamentos (uint64) — o par i ocupa as linhas 2i (entrada) e 2i + 1 (saída);
+//   - "dataset.tokens": os IDs de todas as linhas, concatenados (int32).
+// Abrir o cache é um mmap: input(i) e output(i) devolvem spans direto do arquivo, sem nenhum processamento de texto.
+// Só o cabeçalho é validado ao abrir; cada linha é validada quando lida, então abrir não percorre o corpus.
+class DatasetCache {
+
+public:
+
+    // Compila o cache: grava o vocabulário de 'tokenizer' e os pares formados pelas linhas consecutivas de 'corpus'
+    // (uma linha sem par no final é descartada)
+    static void write(const std::string& path, const Tokenizer& tokenizer, const TokenizedCorpus& corpus, int vocab_size);
+
+    // Mapeia um cache gravado por write (lança std::runtime_error se o arquivo for inválido)
+    explicit DatasetCache(const std::string& path);
+
+    // Número de pares
+    std::size_t size() const { return (offsets.size() - 1) / 2; }
+
+    // IDs da entrada e da saída do par i (sem cópia; válidos enquanto o cache existir)
+    std::span<const int> input(std::size_t i) const { return line(2 * i); }
+    std::span<const int> output(std::size_t i) const { return line(2 * i + 1); }
+
+    // Tamanho do vocabulário usado na compilação
+    int vocabSize() const { return vocab_size; }
+
+    // Carrega no tokenizador o vocabulário gravado no cache
+    void loadVocab(Tokenizer& tokenizer) const { tokenizer.loadVocab(reader); }
+
+private:
+
+    // IDs da linha i (lança std::runtime_error se os deslocamentos ou os IDs da linha forem inválidos)
+    std::span<const int> line(std::size_t i) const;
+
+    // Arquivo mapeado e arrays dentro dele
+    CheckpointReader reader;
+    std::span<const int> tokens;
+    std::span<const uint64_t> offsets;
+    int vocab_size = 0;
+};
+
+#endif
@@ -0,0 +1,106 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se DATASET_STREAM_H já foi definido, para evitar múltiplas inclusões
+#ifndef DATASET_STREAM_H
+
+// Define DATASET_STREAM_H se ainda não tiver sido definido
+#define DATASET_STREAM_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui std::span
+#include <span>
+
+// Inclui std::function
+#include <functional>
+
+// Inclui a biblioteca padrão de threads
+#include <thread>
+
+// Inclui std::exception_ptr, usado para repassar erros da thread de leitura
+#include <exception>
+
+// Inclui o tipo Tensor
+#include "Tensor.hpp"
+
+// Inclui o tokenizador, usado para tokenizar as linhas lidas do texto
+#include "02RMTATokenizer.hpp"
+
+// Inclui o dataset tokenizado mapeado em memória
+#include "DatasetCache.hpp"
+
+// Inclui a fila bloqueante entre a thread de leitura e o consumidor
+#include "BoundedQueue.hpp"
+
+// Um par (entrada, saída) do dataset, com os IDs e, se houver uma etapa de preparação, a entrada já pronta para o
+// forward pass (embeddings com codificação posicional)
+struct Example {
+    std::vector<int> input_tokens;
+    std::vector<int> output_tokens;
+    Tensor encoded_input;
+};
+
+// Declaração da classe DatasetStream, que entrega os pares do dataset por uma fila limitada preenchida por uma thread
+// em segundo plano.
+//
+// A thread de leitura obtém cada par da fonte (texto lido linha a linha, cache tokenizado ou pares em memória), roda a
+// etapa de preparação (por exemplo, embedding e codificação posicional) e coloca o resultado na fila. Assim, a leitura,
+// a tokenização e a preparação dos próximos exemplos acontecem enquanto o consumidor faz o forward pass do atual, e a
+// memória usada fica limitada a 'capacity' exemplos, independentemente do tamanho do corpus.
+// A fonte e a preparação rodam fora da thread chamadora, então só podem usar funções seguras entre threads
+// (tokenização somente leitura, Embedding e PositionalEncoding const).
+class DatasetStream {
+
+public:
+
+    // Fonte de pares: preenche os IDs do próximo exemplo e retorna false quando o dataset acabou
+    using Source = std::function<bool(Example&)>;
+
+    // Etapa de preparação executada na thread de leitura para cada exemplo
+    using Prepare = std::function<void(Example&)>;
+
+    // Fonte que lê um arquivo de texto linha a linha (linhas vazias são ignoradas; linhas consecutivas formam um par).
+    // Exige o vocabulário congelado ou o modo BPE; lança std::runtime_error se o arquivo não puder ser aberto.
+    static Source fromText(const std::string& path, const Tokenizer& tokenizer);
+
+    // Fonte que percorre um cache tokenizado (que deve existir enquanto o stream for usado)
+    static Source fromCache(const DatasetCache& cache);
+
+    // Fonte que percorre pares já tokenizados em memória (que devem existir enquanto o stream for usado)
+    static Source fromPairs(const std::vector<std::span<const int>>& inputs, const std::vector<std::span<const int>>& outputs);
+
+    // Construtor que inicia a thread de leitura; no máximo 'capacity' exemplos prontos ficam esperando na fila
+    DatasetStream(Source source, std::size_t capacity, Prepare prepare = {});
+
+    // Destrutor que interrompe a leitura e espera a thread terminar
+    ~DatasetStream();
+
+    // O stream não pode ser copiado
+    DatasetStream(const DatasetStream&) = delete;
+    DatasetStream& operator=(const DatasetStream&) = delete;
+
+    // Retira o próximo exemplo, esperando se ele ainda não estiver pronto. Retorna false no fim do dataset;
+    // um erro da fonte ou da preparação é relançado aqui, depois dos exemplos anteriores a ele.
+    bool next(Example& example);
+
+private:
+
+    // Laço da thread de leitura
+    void produce(Source source, Prepare prepare);
+
+    // Exemplos prontos
+    BoundedQueue<Example> queue;
+
+    // Erro ocorrido na thread de leitura (lido apenas depois que a fila é fechada)
+    std::exception_ptr error;
+
+    // Thread de leitura (declarada por último, para ser iniciada depois dos outros membros)
+    std::thread producer;
+};
+
+#endif
@@ -22,6 +22,15 @@
 // Inclui funções numéricas como std::accumulate
 #include <numeric>
 
+// Inclui o tipo Tensor, que guarda a matriz de pesos em um bloco contíguo
+#include "Tensor.hpp"
+
+// Inclui o GEMM usado na transformação linear
+#include "VectorOp.hpp"
+
+// Inclui o formato de checkpoint, usado para salvar e carregar os pesos
+#include "Checkpoint.hpp"
+
 // Declaração da classe FinalLayer, responsável pela última camada do modelo
 class FinalLayer {
 
@@ -30,28 +39,63 @@ public:
     // Construtor que inicializa as dimensões de entrada e saída da camada
     explicit FinalLayer(int input_dim, int output_dim);
 
-    // Função que realiza o forward pass na última camada
-    std::vector<double> forward(const std::vector<double>& input) const;
+    // Função que realiza o forward pass na última camada para todas as posições (seq_len x input_dim -> seq_len x output_dim)
+    Tensor forward(const Tensor& input) const;
+
+    // Versão que escreve as probabilidades em output (seq_len x output_dim), sem alocar memória
+    void forward(ConstTensorView input, TensorView output) const;
+
+    // Função que calcula a perda de cross-entropy de todas as posições (seq_len x input_dim) contra os tokens alvo,
+    // sem montar a matriz de probabilidades: os logits são calculados em faixas de até getVocabChunk() colunas do
+    // vocabulário e cada faixa atualiza o máximo e a soma das exponenciais de cada posição (logsumexp online), então a
+    // perda de uma posição é logsumexp(logits) - logit do alvo. Posições com alvo negativo (padding) são ignoradas.
+    // Retorna a soma das perdas; 'losses', se não estiver vazio, recebe a perda de cada posição (0 nas ignoradas).
+    // Com 'gradients' (seq_len x input_dim), também calcula o gradiente da soma das perdas em relação a input,
+    // (softmax - one_hot(alvo)) * W, refazendo os logits de cada faixa em uma segunda passada.
+    double crossEntropy(ConstTensorView input, std::span<const int> targets, std::span<double> losses = {},
+                        TensorView gradients = {}) const;
+
+    // Funções que definem e retornam quantas colunas do vocabulário crossEntropy processa por vez
+    void setVocabChunk(size_t columns) { vocab_chunk = std::max<size_t>(columns, 1); }
+    size_t getVocabChunk() const { return vocab_chunk; }
     
     // Função que atualiza os parâmetros (pesos e bias) com base nos gradientes
-    void updateParameters(std::vector<double>& gradients, int index, double learning_rate);
+    void updateParameters(std::span<const real_t> gradients, int index, double learning_rate);
+
+    // Função que quantiza W em INT8 (uma escala por linha do vocabulário) e libera a versão em ponto flutuante
+    void quantizeWeights();
+
+    // Funções que indicam se os pesos estão quantizados e retornam a memória ocupada por eles
+    bool isQuantized() const { return !W_int8.empty(); }
+    size_t weightBytes() const;
+
+    // Funções que salvam e carregam W e b como as seções prefix.W e prefix.b de um checkpoint
+    void saveParameters(CheckpointWriter& writer, const std::string& prefix) const;
+    void loadParameters(const CheckpointReader& reader, const std::string& prefix);
 
 private:
     
     // Dimensões de entrada e saída
     int input_dim, output_dim;
     
-    // Matriz de pesos W (input_dim x output_dim)
-    std::vector<std::vector<double>> W;
+    // Matriz de pesos W (output_dim x input_dim)
+    Tensor W;
+
+    // Versão INT8 de W (preenchida por quantizeWeights)
+    QuantizedMatrix W_int8;
     
     // Vetor de bias b (output_dim)
-    std::vector<double> b;
+    std::vector<real_t> b;
+
+    // Colunas do vocabulário por faixa em crossEntropy
+    size_t vocab_chunk = 4096;
 
-    // Função auxiliar que aplica uma transformação linear ao input
-    std::vector<double> linear(const std::vector<double>& input) const;
+    // Função auxiliar que aplica a transformação linear a todas as posições, escrevendo em output as colunas
+    // [first, first + output.cols()) dos logits (seq_len x input_dim -> seq_len x output.cols())
+    void linear(ConstTensorView input, TensorView output, size_t first = 0) const;
     
-    // Função auxiliar que aplica softmax para normalizar as saídas
-    std::vector<double> softmax(const std::vector<double>& input) const;
+    // Função auxiliar que aplica softmax para normalizar as saídas (no próprio vetor)
+    void softmax(std::span<real_t> values) const;
 };
 
 #endif
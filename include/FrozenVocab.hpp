@@ -0,0 +1,127 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se FROZEN_VOCAB_H já foi definido, para evitar múltiplas inclusões
+#ifndef FROZEN_VOCAB_H
+
+// Define FROZEN_VOCAB_H se ainda não tiver sido definido
+#define FROZEN_VOCAB_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui std::string_view
+#include <string_view>
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui std::span
+#include <span>
+
+// Inclui os inteiros de tamanho fixo
+#include <cstdint>
+
+// Inclui std::shared_ptr
+#include <memory>
+
+// Token usado para palavras fora do vocabulário
+constexpr std::string_view UNKNOWN_TOKEN = "<unk>";
+
+// Formato binário do vocabulário (inteiros little-endian), pensado para ser usado direto de um arquivo mapeado:
+//
+//   [cabeçalho, 64 bytes][uint32 offsets[word_count + 1]][Slot slots[slot_count]][arena de caracteres]
+//
+// O cabeçalho guarda a identificação, a versão, word_count, slot_count, o ID de <unk> e o tamanho da arena.
+// Como a tabela hash é gravada pronta, carregar o vocabulário não reconstrói nenhuma estrutura: o custo é o de um mmap.
+constexpr char VOCAB_MAGIC[8] = {'B', 'B', 'V', 'O', 'C', 'A', 'B', '\0'};
+constexpr uint32_t VOCAB_VERSION = 1;
+
+// Declaração da classe FrozenVocab, um vocabulário palavra -> ID somente leitura.
+//
+// As palavras ficam concatenadas em uma única arena de caracteres, com uma tabela de deslocamentos indexada pelo ID,
+// e a busca usa uma tabela hash de endereçamento aberto (sondagem linear) em que cada posição guarda parte do hash
+// da palavra: a comparação de strings só acontece quando os hashes coincidem. Como nada é modificado depois da
+// construção, todas as funções const podem ser chamadas de várias threads ao mesmo tempo.
+// Os dados (arena, deslocamentos e tabela) são compartilhados entre cópias e podem vir de um arquivo mapeado (load).
+class FrozenVocab {
+
+public:
+
+    // Vocabulário vazio
+    FrozenVocab() = default;
+
+    // Constrói o vocabulário a partir das palavras ordenadas por ID. Se UNKNOWN_TOKEN não estiver entre elas,
+    // ele é acrescentado com o próximo ID livre.
+    static FrozenVocab build(const std::vector<std::string>& words_by_id);
+
+    // Grava o vocabulário no formato binário (lança std::runtime_error em caso de falha)
+    void save(const std::string& path) const;
+
+    // Mapeia um vocabulário binário com mmap e o usa sem cópia (lança std::runtime_error se o arquivo for inválido)
+    static FrozenVocab load(const std::string& path);
+
+    // Retorna o ID da palavra, ou -1 se ela não estiver no vocabulário
+    int find(std::string_view word) const { return find(word, hash(word)); }
+
+    // Retorna o ID da palavra, ou o ID de UNKNOWN_TOKEN se ela não estiver no vocabulário
+    int id(std::string_view word) const {
+        int token = find(word);
+        return token < 0 ? unk_id : token;
+    }
+
+    // Divide o texto em palavras (separadas por espaços em branco) e escreve o ID de cada uma em 'output', sem alocar.
+    // Retorna o número total de palavras; se for maior que output.size(), apenas as primeiras output.size() foram escritas.
+    std::size_t tokenize(std::string_view text, std::span<int> output) const;
+
+    // Retorna a palavra correspondente a um ID (sem cópia)
+    std::string_view word(int token_id) const {
+        return std::string_view(arena.data() + offsets[token_id], offsets[token_id + 1] - offsets[token_id]);
+    }
+
+    // Retorna o número de palavras e o ID de UNKNOWN_TOKEN
+    int size() const { return offsets.empty() ? 0 : static_cast<int>(offsets.size() - 1); }
+    int unkId() const { return unk_id; }
+
+    // Hash FNV-1a de 64 bits
+    static uint64_t hash(std::string_view word);
+
+private:
+
+    // Posição da tabela hash: 32 bits altos do hash da palavra e seu ID (-1 quando vazia)
+    struct Slot {
+        uint32_t tag;
+        int32_t id;
+    };
+
+    // Busca com o hash já calculado
+    int find(std::string_view word, uint64_t word_hash) const;
+
+    // Cabeçalho do formato binário
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t word_count;
+        uint32_t slot_count;
+        int32_t unk_id;
+        uint64_t arena_bytes;
+        uint8_t reserved[32];
+    };
+    static_assert(sizeof(Header) == 64, "FrozenVocab::Header deve ter 64 bytes");
+
+    // Caracteres de todas as palavras, na ordem dos IDs, e início de cada palavra (offsets[size()] é o fim da arena)
+    std::span<const char> arena;
+    std::span<const uint32_t> offsets;
+
+    // Tabela hash (tamanho potência de 2, ocupação de no máximo 50%)
+    std::span<const Slot> slots;
+    uint64_t mask = 0;
+
+    // ID de UNKNOWN_TOKEN
+    int unk_id = -1;
+
+    // Dono da memória apontada pelos spans (vetores próprios ou o arquivo mapeado)
+    std::shared_ptr<const void> owner;
+};
+
+#endif
@@ -0,0 +1,70 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se GEMM_KERNELS_H já foi definido, para evitar múltiplas inclusões
+#ifndef GEMM_KERNELS_H
+
+// Define GEMM_KERNELS_H se ainda não tiver sido definido
+#define GEMM_KERNELS_H
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui os inteiros de tamanho fixo usados nos kernels INT8
+#include <cstdint>
+
+// Micro-kernel de GEMM: calcula um bloco MR x NR de C a partir de painéis empacotados.
+// O painel de A guarda, para cada passo p de 0 a kc-1, MR valores consecutivos (uma coluna do bloco de A);
+// o painel de B guarda, para cada p, NR valores consecutivos (uma linha do bloco de B).
+// O micro-kernel acumula C += A * B, com 'ldc' elementos entre linhas consecutivas de C.
+template <typename T>
+struct GemmMicroKernel {
+
+    // Dimensões do bloco de registradores calculado por chamada
+    std::size_t mr = 0, nr = 0;
+
+    // Acumula o produto dos painéis em C
+    void (*compute)(std::size_t kc, const T* a_panel, const T* b_panel, T* c, std::size_t ldc) = nullptr;
+
+    // Produto escalar de dois vetores contíguos (usado quando A tem poucas linhas e B é transposta)
+    T (*dot)(const T* x, const T* y, std::size_t n) = nullptr;
+};
+
+// Conjunto de kernels de um conjunto de instruções (ISA)
+struct GemmBackend {
+
+    // Nome do conjunto de instruções (scalar, sse2, avx2, avx512)
+    const char* name = "";
+
+    // Kernels de precisão simples e dupla
+    GemmMicroKernel<float> f32;
+    GemmMicroKernel<double> f64;
+};
+
+// Kernels disponíveis; as versões SIMD retornam nullptr quando não foram compiladas para esta arquitetura
+const GemmBackend* gemmBackendScalar();
+const GemmBackend* gemmBackendSSE2();
+const GemmBackend* gemmBackendAVX2();
+const GemmBackend* gemmBackendAVX512();
+
+// Kernels INT8: produtos escalares entre ativações sem sinal (u8) e pesos com sinal (s8), acumulados em int32.
+// 'n' é múltiplo de 64 e os vetores estão alinhados em 64 bytes (ver QuantizedMatrix).
+struct Int8Backend {
+
+    // Nome do conjunto de instruções (scalar, avx2, avxvnni, avx512vnni)
+    const char* name = "";
+
+    // out[r] = soma de x[p] * w[r * stride + p] para as 4 linhas r de w (reaproveita cada carga de x quatro vezes)
+    void (*dot4)(const uint8_t* x, const int8_t* w, std::size_t stride, std::size_t n, int32_t* out) = nullptr;
+
+    // Produto escalar de uma única linha (usado nas linhas que sobram)
+    int32_t (*dot)(const uint8_t* x, const int8_t* w, std::size_t n) = nullptr;
+};
+
+// Kernels INT8 disponíveis; as versões SIMD retornam nullptr quando não foram compiladas para esta arquitetura
+const Int8Backend* int8BackendScalar();
+const Int8Backend* int8BackendAVX2();
+const Int8Backend* int8BackendAVXVNNI();
+const Int8Backend* int8BackendAVX512VNNI();
+
+#endif
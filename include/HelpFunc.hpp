@@ -22,40 +22,58 @@
 // Inclui funções numéricas padrão (como std::accumulate)
 #include <numeric>
 
+// Inclui std::span, para receber linhas de um Tensor sem cópia
+#include <span>
+
+// Inclui o tipo escalar do modelo (real_t)
+#include "Tensor.hpp"
+
 // Declaração da classe Utils, contendo funções auxiliares
 class Utils {
     
 public:
     
     // Função estática que verifica se um vetor contém algum valor NaN (Not a Number)
-    static bool containsNaN(const std::vector<double>& vec) {
+    static bool containsNaN(std::span<const real_t> vec) {
 
         // Usa std::any_of para checar se algum elemento do vetor é NaN
         return std::any_of(vec.begin(), vec.end(), [](float x) { return std::isnan(x); });
     }
 
     // Função estática que aplica a função softmax a um vetor de scores
-    static std::vector<double> softmax(const std::vector<double>& scores) {
+    static std::vector<real_t> softmax(std::span<const real_t> scores) {
         
-        // Vetor que armazenará os valores exponenciais de cada score
-        std::vector<double> expScores(scores.size());
+        // Copia os scores e normaliza a cópia
+        std::vector<real_t> expScores(scores.begin(), scores.end());
+        softmaxInPlace(expScores);
+
+        // Retorna o vetor normalizado de probabilidades
+        return expScores;
+    }
+
+    // Função estática que aplica a softmax no próprio vetor, de forma numericamente estável
+    static void softmaxInPlace(std::span<real_t> scores) {
+        
+        if (scores.empty()) {
+            return;
+        }
+
+        // Subtrai o maior score antes da exponencial para evitar overflow
+        real_t maxScore = *std::max_element(scores.begin(), scores.end());
         
         // Variável para armazenar a soma dos valores exponenciais
-        double sumExpScores = 0.0;
+        real_t sumExpScores = 0;
 
         // Calcula a exponencial de cada score e soma os resultados
-        for (size_t i = 0; i < scores.size(); ++i) {
-            expScores[i] = std::exp(scores[i]);
-            sumExpScores += expScores[i];
+        for (real_t& score : scores) {
+            score = std::exp(score - maxScore);
+            sumExpScores += score;
         }
 
         // Divide cada valor exponencial pela soma total para obter as probabilidades (softmax)
-        for (size_t i = 0; i < expScores.size(); ++i) {
-            expScores[i] /= sumExpScores;
+        for (real_t& score : scores) {
+            score /= sumExpScores;
         }
-
-        // Retorna o vetor normalizado de probabilidades
-        return expScores;
     }
 };
 
@@ -0,0 +1,61 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se KV_CACHE_H já foi definido, para evitar múltiplas inclusões
+#ifndef KV_CACHE_H
+
+// Define KV_CACHE_H se ainda não tiver sido definido
+#define KV_CACHE_H
+
+// Inclui o tipo Tensor
+#include "Tensor.hpp"
+
+// Cache de keys e values de uma camada de atenção, pré-alocado para até max_seq_len posições.
+// Cada passo de decodificação escreve a nova posição na linha 'length' e incrementa 'length'.
+struct KVCache {
+
+    // Keys e values de todas as cabeças (max_seq_len x model_dim); apenas as primeiras 'length' linhas são válidas
+    Tensor keys, values;
+
+    // Número de posições já armazenadas
+    size_t length = 0;
+
+    // Reserva espaço para 'max_seq_len' posições e esvazia o cache
+    void reserve(size_t max_seq_len, size_t model_dim) {
+        keys.resize(max_seq_len, model_dim);
+        values.resize(max_seq_len, model_dim);
+        length = 0;
+    }
+
+    // Número máximo de posições
+    size_t capacity() const { return keys.rows(); }
+
+    // Esvazia o cache sem liberar memória
+    void clear() { length = 0; }
+
+    // Views sobre as posições válidas
+    ConstTensorView validKeys() const { return keys.block(0, length, 0, keys.cols()); }
+    ConstTensorView validValues() const { return values.block(0, length, 0, values.cols()); }
+};
+
+// Buffers temporários de um passo de atenção incremental (uma única query), pré-alocados junto com o cache
+struct AttentionScratch {
+
+    // Query da nova posição (1 x model_dim)
+    Tensor query;
+
+    // Scores da query contra todas as posições do cache (1 x max_seq_len)
+    Tensor scores;
+
+    // Saída das cabeças concatenadas (1 x model_dim)
+    Tensor heads;
+
+    // Reserva os buffers para até 'max_seq_len' posições
+    void reserve(size_t max_seq_len, size_t model_dim) {
+        query.resize(1, model_dim);
+        scores.resize(1, max_seq_len);
+        heads.resize(1, model_dim);
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se LAYER_PIPELINE_H já foi definido, para evitar múltiplas inclusões
+#ifndef LAYER_PIPELINE_H
+
+// Define LAYER_PIPELINE_H se ainda não tiver sido definido
+#define LAYER_PIPELINE_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui a biblioteca padrão de threads
+#include <thread>
+
+// Inclui std::mutex, que protege a primeira exceção dos estágios
+#include <mutex>
+
+// Inclui std::atomic
+#include <atomic>
+
+// Inclui std::function
+#include <functional>
+
+// Inclui std::unique_ptr
+#include <memory>
+
+// Inclui std::exception_ptr
+#include <exception>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui a fila sem locks que liga os estágios
+#include "SpscQueue.hpp"
+
+// Inclui o encoder, o decoder e a camada final, cujas camadas são distribuídas entre os estágios
+#include "08RMTAEncoder.hpp"
+#include "10RMTADecoder.hpp"
+#include "FinalLayer.hpp"
+
+// Inclui os exemplos do dataset, que viajam junto com o lote
+#include "DatasetStream.hpp"
+
+// Lote em trânsito pelo pipeline: os exemplos, a disposição deles nas sequências e as ativações entre os estágios
+struct PipelineBatch {
+    std::vector<Example> examples;
+    BatchLayout layout;
+
+    // Lote com padding, entrada do encoder e do decoder
+    Tensor input;
+
+    // Saída da última camada do encoder, usada pela cross-attention de todas as camadas do decoder
+    Tensor encoder_output;
+
+    // Saída da última camada aplicada até aqui
+    Tensor hidden;
+
+    // Saída da camada final (uma linha de probabilidades por posição do lote)
+    Tensor probabilities;
+};
+
+// Declaração da classe LayerPipeline, que executa o encoder, o decoder e a camada final em paralelo por camadas.
+//
+// As camadas (na ordem encoder, decoder, camada final) são divididas em 'stages' grupos contíguos de custo parecido,
+// cada um com a sua thread. Os lotes entram por uma thread que chama 'source' e passam de um estágio para o seguinte
+// por filas SpscQueue limitadas, então enquanto um lote está nas últimas camadas do decoder, os seguintes já estão
+// no começo do decoder e no encoder: o número de núcleos ocupados cresce com o número de estágios mesmo quando cada
+// camada sozinha não aproveita mais threads. Cada camada é usada por uma única thread e os lotes saem na ordem em que
+// entraram, com o mesmo resultado do forward sequencial.
+class LayerPipeline {
+
+public:
+
+    // Função que produz o próximo lote (já com 'input' e 'layout' preenchidos), ou nullptr quando não há mais lotes
+    using Source = std::function<std::unique_ptr<PipelineBatch>()>;
+
+    // Construtor que divide as camadas em 'stages' estágios (no mínimo 1, no máximo uma camada por estágio), com até
+    // 'queue_capacity' lotes esperando entre dois estágios, e inicia as threads
+    LayerPipeline(Source source, Encoder& encoder, Decoder& decoder, const FinalLayer& finalLayer,
+                  std::size_t stages, std::size_t queue_capacity = 2);
+
+    // Destrutor que interrompe a entrada de lotes, descarta os que ainda estão no pipeline e encerra as threads
+    ~LayerPipeline();
+
+    // O pipeline não pode ser copiado
+    LayerPipeline(const LayerPipeline&) = delete;
+    LayerPipeline& operator=(const LayerPipeline&) = delete;
+
+    // Retorna o próximo lote com 'probabilities' preenchido, esperando se necessário, ou nullptr quando todos os lotes
+    // já saíram. Se 'source' ou alguma camada lançou uma exceção, ela é relançada aqui no lugar do fim dos lotes.
+    std::unique_ptr<PipelineBatch> next();
+
+    // Número de estágios (threads de camadas)
+    std::size_t numStages() const;
+
+private:
+
+    // Uma camada aplicada a um lote
+    using Unit = std::function<void(PipelineBatch&)>;
+
+    // Fila entre dois estágios; nullptr marca o fim dos lotes
+    using Link = SpscQueue<std::unique_ptr<PipelineBatch>>;
+
+    // Laço da thread de entrada e laço da thread de cada estágio
+    void sourceLoop();
+    void stageLoop(std::size_t stage);
+
+    // Guarda a primeira exceção e interrompe a entrada de lotes
+    void fail(std::exception_ptr exception);
+
+    // Espera todas as threads terminarem
+    void join();
+
+    // Produtor dos lotes e camadas de cada estágio
+    Source source;
+    std::vector<std::vector<Unit>> stages;
+
+    // links[0] liga a entrada ao estágio 0, links[s + 1] liga o estágio s ao seguinte (o último vai para next())
+    std::vector<std::unique_ptr<Link>> links;
+
+    // Primeira exceção de uma thread, protegida por 'error_mutex'
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // Sinaliza à thread de entrada que não deve produzir mais lotes
+    std::atomic<bool> stopping{false};
+
+    // Se o último lote já saiu por next()
+    bool finished = false;
+
+    // Thread de entrada seguida das threads dos estágios
+    std::vector<std::thread> threads;
+};
+
+#endif
@@ -0,0 +1,50 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se MAPPED_FILE_H já foi definido, para evitar múltiplas inclusões
+#ifndef MAPPED_FILE_H
+
+// Define MAPPED_FILE_H se ainda não tiver sido definido
+#define MAPPED_FILE_H
+
+// Inclui a biblioteca padrão de strings
+#include <string>
+
+// Inclui std::shared_ptr
+#include <memory>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Declaração da classe MappedFile, um arquivo inteiro mapeado em memória com mmap.
+// O mapeamento é privado (copy-on-write): enquanto ninguém escreve, todos os processos que abrem o mesmo arquivo
+// compartilham as páginas do page cache; uma escrita copia apenas a página alterada, sem tocar no arquivo.
+class MappedFile {
+
+public:
+
+    // Mapeia o arquivo 'path' inteiro (lança std::runtime_error se o arquivo não puder ser aberto ou mapeado)
+    static std::shared_ptr<MappedFile> open(const std::string& path);
+
+    // Desfaz o mapeamento
+    ~MappedFile();
+
+    // O mapeamento não pode ser copiado
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Início do arquivo na memória (alinhado à página) e tamanho em bytes
+    char* data() const { return address; }
+    std::size_t size() const { return length; }
+
+private:
+
+    // Construído apenas por open
+    MappedFile(char* address, std::size_t length) : address(address), length(length) {}
+
+    // Endereço e tamanho do mapeamento
+    char* address = nullptr;
+    std::size_t length = 0;
+};
+
+#endif
@@ -0,0 +1,57 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se QUANTIZATION_H já foi definido, para evitar múltiplas inclusões
+#ifndef QUANTIZATION_H
+
+// Define QUANTIZATION_H se ainda não tiver sido definido
+#define QUANTIZATION_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui os inteiros de tamanho fixo (int8_t, int32_t)
+#include <cstdint>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui o tipo Tensor e o alocador alinhado
+#include "Tensor.hpp"
+
+// As linhas de uma matriz INT8 são completadas com zeros até um múltiplo deste valor (um registrador AVX-512 de bytes)
+constexpr std::size_t INT8_COLUMN_ALIGNMENT = 64;
+
+// Matriz de pesos quantizada em INT8 com uma escala por canal de saída (linha), no formato saída x entrada.
+// W(i, j) ≈ scales[i] * weights(i, j), com weights em [-127, 127] (quantização simétrica, sem ponto zero).
+struct QuantizedMatrix {
+
+    // Dimensões da matriz original e passo (em bytes) entre linhas de 'weights'
+    std::size_t rows = 0, cols = 0, stride = 0;
+
+    // Pesos inteiros (rows x stride); as colunas além de 'cols' são zero
+    std::vector<int8_t, AlignedAllocator<int8_t>> weights;
+
+    // Escala de cada linha
+    std::vector<float> scales;
+
+    // Soma dos pesos inteiros de cada linha, usada para descontar o ponto zero das ativações sem sinal
+    std::vector<int32_t> row_sums;
+
+    // Quantiza uma matriz em ponto flutuante (quantizador offline: roda uma vez, antes da inferência)
+    static QuantizedMatrix quantize(MatrixView<const real_t> matrix);
+
+    // Reconstrói a matriz em ponto flutuante (para medir o erro de quantização)
+    Tensor dequantize() const;
+
+    // Ponteiro para a linha i
+    const int8_t* row(std::size_t i) const { return weights.data() + i * stride; }
+
+    // Indica se a matriz está vazia (camada não quantizada)
+    bool empty() const { return rows == 0; }
+
+    // Memória ocupada pelos pesos, escalas e somas
+    std::size_t bytes() const { return weights.size() + scales.size() * sizeof(float) + row_sums.size() * sizeof(int32_t); }
+};
+
+#endif
@@ -0,0 +1,86 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se SPSC_QUEUE_H já foi definido, para evitar múltiplas inclusões
+#ifndef SPSC_QUEUE_H
+
+// Define SPSC_QUEUE_H se ainda não tiver sido definido
+#define SPSC_QUEUE_H
+
+// Inclui os contadores atômicos (e std::atomic::wait/notify, usados para bloquear sem mutex)
+#include <atomic>
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui std::move
+#include <utility>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Declaração da classe SpscQueue, uma fila circular de capacidade fixa sem locks para exatamente uma thread produtora
+// e uma thread consumidora (um elo entre dois estágios de um pipeline).
+//
+// O produtor só escreve 'tail' e o consumidor só escreve 'head', então cada operação é uma leitura do contador do
+// outro lado (acquire) e uma escrita no próprio (release). Com a fila cheia ou vazia, a thread dorme em
+// std::atomic::wait até o outro lado mover o seu contador, em vez de girar consumindo o núcleo.
+template <typename T>
+class SpscQueue {
+
+public:
+
+    // Construtor que define quantos itens podem esperar na fila (arredondado para uma potência de 2, no mínimo 1)
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) {
+            size *= 2;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // A fila não pode ser copiada
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Insere um item, esperando enquanto a fila estiver cheia (apenas a thread produtora chama)
+    void push(T item) {
+        const std::size_t t = tail.load(std::memory_order_relaxed);
+        std::size_t h = head.load(std::memory_order_acquire);
+        while (t - h == slots.size()) {
+            head.wait(h, std::memory_order_acquire);
+            h = head.load(std::memory_order_acquire);
+        }
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        tail.notify_one();
+    }
+
+    // Retira o próximo item, esperando enquanto a fila estiver vazia (apenas a thread consumidora chama)
+    T pop() {
+        const std::size_t h = head.load(std::memory_order_relaxed);
+        std::size_t t = tail.load(std::memory_order_acquire);
+        while (t == h) {
+            tail.wait(t, std::memory_order_acquire);
+            t = tail.load(std::memory_order_acquire);
+        }
+        T item = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        head.notify_one();
+        return item;
+    }
+
+private:
+
+    // Posições da fila circular e máscara do índice (capacidade - 1)
+    std::vector<T> slots;
+    std::size_t mask = 0;
+
+    // Próximo item a retirar (escrito pelo consumidor) e próxima posição livre (escrita pelo produtor), em linhas de
+    // cache separadas para os dois lados não disputarem a mesma linha
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+#endif
@@ -0,0 +1,252 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se TENSOR_H já foi definido, para evitar múltiplas inclusões
+#ifndef TENSOR_H
+
+// Define TENSOR_H se ainda não tiver sido definido
+#define TENSOR_H
+
+// Inclui a biblioteca padrão de vetores (armazenamento contíguo)
+#include <vector>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Inclui o operador new com alinhamento (std::align_val_t)
+#include <new>
+
+// Inclui std::span, usado para expor linhas sem cópia
+#include <span>
+
+// Inclui exceções padrão para tratamento de erros
+#include <stdexcept>
+
+// Inclui algoritmos genéricos (como std::fill e std::copy)
+#include <algorithm>
+
+// Inclui std::is_const e afins, usados nas conversões entre views
+#include <type_traits>
+
+// Inclui std::shared_ptr, que mantém viva a memória emprestada de um tensor
+#include <memory>
+
+// Inclui std::exchange
+#include <utility>
+
+// Alinhamento (em bytes) do bloco de dados de cada tensor: uma linha de cache e um registrador AVX-512
+constexpr std::size_t TENSOR_ALIGNMENT = 64;
+
+// Alocador que devolve memória alinhada em TENSOR_ALIGNMENT bytes
+template <typename T>
+struct AlignedAllocator {
+
+    using value_type = T;
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    // Aloca n elementos em um único bloco alinhado
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(TENSOR_ALIGNMENT)));
+    }
+
+    // Libera o bloco alocado por allocate
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(TENSOR_ALIGNMENT));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U>&) const noexcept { return false; }
+};
+
+// View não proprietária de uma matriz row-major com passo (stride) entre linhas.
+// Não aloca nada: serve para expor linhas, blocos de linhas e fatias de colunas de um tensor.
+template <typename T>
+class MatrixView {
+
+public:
+
+    // View vazia
+    MatrixView() = default;
+
+    // View sobre 'rows' linhas de 'cols' elementos, com 'stride' elementos entre o início de linhas consecutivas
+    MatrixView(T* data, std::size_t rows, std::size_t cols, std::size_t stride)
+        : ptr(data), n_rows(rows), n_cols(cols), row_stride(stride) {}
+
+    // View contígua (stride == cols)
+    MatrixView(T* data, std::size_t rows, std::size_t cols)
+        : MatrixView(data, rows, cols, cols) {}
+
+    // Permite converter MatrixView<double> em MatrixView<const double>
+    template <typename U, typename = std::enable_if_t<std::is_same_v<T, const U>>>
+    MatrixView(const MatrixView<U>& other)
+        : ptr(other.data()), n_rows(other.rows()), n_cols(other.cols()), row_stride(other.stride()) {}
+
+    // Acesso aos dados e às dimensões
+    T* data() const { return ptr; }
+    std::size_t rows() const { return n_rows; }
+    std::size_t cols() const { return n_cols; }
+    std::size_t stride() const { return row_stride; }
+    bool empty() const { return n_rows == 0 || n_cols == 0; }
+
+    // Indica se as linhas estão encostadas umas nas outras na memória
+    bool contiguous() const { return row_stride == n_cols || n_rows <= 1; }
+
+    // Retorna a linha i como um span (sem cópia)
+    std::span<T> row(std::size_t i) const { return std::span<T>(ptr + i * row_stride, n_cols); }
+
+    // Acesso ao elemento (i, j)
+    T& operator()(std::size_t i, std::size_t j) const { return ptr[i * row_stride + j]; }
+
+    // Sub-bloco com 'rows' linhas a partir de r0 e 'cols' colunas a partir de c0
+    MatrixView block(std::size_t r0, std::size_t rows, std::size_t c0, std::size_t cols) const {
+        if (r0 + rows > n_rows || c0 + cols > n_cols) {
+            throw std::out_of_range("MatrixView::block: bloco fora dos limites da matriz.");
+        }
+        return MatrixView(ptr + r0 * row_stride + c0, rows, cols, row_stride);
+    }
+
+    // Intervalo de linhas [r0, r0 + rows) com todas as colunas
+    MatrixView rowRange(std::size_t r0, std::size_t rows) const { return block(r0, rows, 0, n_cols); }
+
+    // Intervalo de colunas [c0, c0 + cols) com todas as linhas
+    MatrixView colRange(std::size_t c0, std::size_t cols) const { return block(0, n_rows, c0, cols); }
+
+private:
+
+    // Ponteiro para o primeiro elemento e geometria da view
+    T* ptr = nullptr;
+    std::size_t n_rows = 0, n_cols = 0, row_stride = 0;
+};
+
+// Tensor bidimensional row-major: todos os elementos ficam em um único bloco alinhado.
+// Normalmente o tensor é dono do bloco; um tensor criado com borrow() usa memória de outro dono (por exemplo, um
+// checkpoint mapeado com mmap) sem copiar, e mantém esse dono vivo enquanto existir.
+template <typename T>
+class BasicTensor {
+
+public:
+
+    // Tensor vazio
+    BasicTensor() = default;
+
+    // Tensor com 'rows' linhas e 'cols' colunas, preenchido com 'value'
+    BasicTensor(std::size_t rows, std::size_t cols, T value = T())
+        : n_rows(rows), n_cols(cols), buffer(rows * cols, value) {}
+
+    // Copia o conteúdo de uma view (possivelmente com stride) para um novo bloco contíguo
+    explicit BasicTensor(MatrixView<const T> view) : BasicTensor(view.rows(), view.cols()) {
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            std::copy(view.row(i).begin(), view.row(i).end(), row(i).begin());
+        }
+    }
+
+    // A cópia é sempre proprietária (copiar um tensor emprestado copia os dados)
+    BasicTensor(const BasicTensor& other)
+        : n_rows(other.n_rows), n_cols(other.n_cols), buffer(other.data(), other.data() + other.size()) {}
+
+    BasicTensor(BasicTensor&& other) noexcept
+        : n_rows(std::exchange(other.n_rows, 0)), n_cols(std::exchange(other.n_cols, 0)), buffer(std::move(other.buffer)),
+          borrowed_data(std::exchange(other.borrowed_data, nullptr)), owner(std::move(other.owner)) {}
+
+    BasicTensor& operator=(const BasicTensor& other) {
+        if (this != &other) {
+            *this = BasicTensor(other);
+        }
+        return *this;
+    }
+
+    BasicTensor& operator=(BasicTensor&& other) noexcept {
+        n_rows = std::exchange(other.n_rows, 0);
+        n_cols = std::exchange(other.n_cols, 0);
+        buffer = std::move(other.buffer);
+        borrowed_data = std::exchange(other.borrowed_data, nullptr);
+        owner = std::move(other.owner);
+        return *this;
+    }
+
+    // Cria um tensor sobre 'rows' x 'cols' elementos contíguos em 'data', sem copiar; 'owner' mantém a memória viva
+    static BasicTensor borrow(T* data, std::size_t rows, std::size_t cols, std::shared_ptr<const void> owner) {
+        BasicTensor tensor;
+        tensor.n_rows = rows;
+        tensor.n_cols = cols;
+        tensor.borrowed_data = data;
+        tensor.owner = std::move(owner);
+        return tensor;
+    }
+
+    // Indica se os dados pertencem a outro dono (ver borrow)
+    bool borrowed() const { return borrowed_data != nullptr; }
+
+    // Redimensiona o tensor (o conteúdo anterior não é preservado e o tensor passa a ser dono dos dados)
+    void resize(std::size_t rows, std::size_t cols, T value = T()) {
+        n_rows = rows;
+        n_cols = cols;
+        buffer.assign(rows * cols, value);
+        borrowed_data = nullptr;
+        owner.reset();
+    }
+
+    // Preenche todos os elementos com 'value'
+    void fill(T value) { std::fill(data(), data() + size(), value); }
+
+    // Acesso aos dados e às dimensões
+    T* data() { return borrowed_data != nullptr ? borrowed_data : buffer.data(); }
+    const T* data() const { return borrowed_data != nullptr ? borrowed_data : buffer.data(); }
+    std::size_t rows() const { return n_rows; }
+    std::size_t cols() const { return n_cols; }
+    std::size_t stride() const { return n_cols; }
+    std::size_t size() const { return n_rows * n_cols; }
+    bool empty() const { return size() == 0; }
+
+    // Retorna a linha i como um span (sem cópia)
+    std::span<T> row(std::size_t i) { return std::span<T>(data() + i * n_cols, n_cols); }
+    std::span<const T> row(std::size_t i) const { return std::span<const T>(data() + i * n_cols, n_cols); }
+
+    // Acesso ao elemento (i, j)
+    T& operator()(std::size_t i, std::size_t j) { return data()[i * n_cols + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const { return data()[i * n_cols + j]; }
+
+    // Views não proprietárias sobre o tensor inteiro
+    MatrixView<T> view() { return MatrixView<T>(data(), n_rows, n_cols); }
+    MatrixView<const T> view() const { return MatrixView<const T>(data(), n_rows, n_cols); }
+    operator MatrixView<T>() { return view(); }
+    operator MatrixView<const T>() const { return view(); }
+
+    // Sub-blocos (ver MatrixView::block)
+    MatrixView<T> block(std::size_t r0, std::size_t rows, std::size_t c0, std::size_t cols) { return view().block(r0, rows, c0, cols); }
+    MatrixView<const T> block(std::size_t r0, std::size_t rows, std::size_t c0, std::size_t cols) const { return view().block(r0, rows, c0, cols); }
+
+private:
+
+    // Dimensões do tensor
+    std::size_t n_rows = 0, n_cols = 0;
+
+    // Bloco único e alinhado com rows * cols elementos (vazio quando o tensor é emprestado)
+    std::vector<T, AlignedAllocator<T>> buffer;
+
+    // Dados emprestados e o dono que os mantém vivos (ver borrow)
+    T* borrowed_data = nullptr;
+    std::shared_ptr<const void> owner;
+};
+
+// Tipo escalar do modelo: float (32 bits) por padrão, que dobra a largura SIMD e reduz pela metade memória e banda.
+// Compile com -DBUMBLEBEE_USE_DOUBLE para rodar tudo em precisão dupla (útil para verificações de referência).
+#ifdef BUMBLEBEE_USE_DOUBLE
+using real_t = double;
+#else
+using real_t = float;
+#endif
+
+// Tipos usados pelo modelo
+using Tensor = BasicTensor<real_t>;
+using TensorView = MatrixView<real_t>;
+using ConstTensorView = MatrixView<const real_t>;
+
+#endif
@@ -0,0 +1,125 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se THREAD_POOL_H já foi definido, para evitar múltiplas inclusões
+#ifndef THREAD_POOL_H
+
+// Define THREAD_POOL_H se ainda não tiver sido definido
+#define THREAD_POOL_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui a biblioteca padrão de threads
+#include <thread>
+
+// Inclui mutex e variáveis de condição para a fila de tarefas
+#include <mutex>
+#include <condition_variable>
+
+// Inclui std::addressof e std::forward
+#include <memory>
+#include <utility>
+
+// Inclui std::decay_t e afins, usados por FunctionRef
+#include <type_traits>
+
+// Inclui tipos de tamanho como std::size_t
+#include <cstddef>
+
+// Menor número de posições por faixa nos laços paralelos por posição (soma residual, normalização, bias, softmax):
+// abaixo disso, o custo de despachar a faixa passa do custo de processá-la
+inline constexpr std::size_t ROW_PARALLEL_GRAIN = 16;
+
+// Referência não proprietária a uma função: ao contrário de std::function, nunca copia nem aloca a função, então
+// só pode ser usada enquanto a função referenciada existir (por exemplo, durante a chamada que a recebeu)
+template <typename Signature>
+class FunctionRef;
+
+template <typename R, typename... Args>
+class FunctionRef<R(Args...)> {
+
+public:
+
+    // Referencia qualquer objeto chamável com a assinatura R(Args...)
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, FunctionRef>>>
+    FunctionRef(F&& function)
+        : object(const_cast<void*>(static_cast<const void*>(std::addressof(function)))),
+          call([](void* object, Args... args) -> R {
+              return (*static_cast<std::remove_reference_t<F>*>(object))(std::forward<Args>(args)...);
+          }) {}
+
+    // Chama a função referenciada
+    R operator()(Args... args) const { return call(object, std::forward<Args>(args)...); }
+
+private:
+
+    // Objeto chamável e função que o invoca
+    void* object;
+    R (*call)(void*, Args...);
+};
+
+// Estado de um parallelFor em andamento (definido em ThreadPool.cpp)
+struct ParallelForJob;
+
+// Declaração da classe ThreadPool, um conjunto fixo de threads que executa laços paralelos
+class ThreadPool {
+
+public:
+
+    // Construtor que cria 'num_threads' threads de trabalho (0 usa o número de núcleos da máquina).
+    // Com pin_threads, a trabalhadora i (de 1 a num_threads - 1) fica presa ao i-ésimo núcleo que o processo pode usar,
+    // o que evita migrações entre núcleos e mantém os dados de cada thread no mesmo cache (apenas no Linux).
+    explicit ThreadPool(std::size_t num_threads = 0, bool pin_threads = false);
+
+    // Destrutor que encerra as threads de trabalho
+    ~ThreadPool();
+
+    // O pool não pode ser copiado
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Executa fn(i) para cada i em [0, count), distribuindo os índices entre as threads, e espera todos terminarem.
+    // A thread chamadora também processa índices, então chamadas aninhadas não travam mesmo com o pool ocupado.
+    // Se fn lançar uma exceção, os demais índices ainda são processados e a primeira exceção é relançada aqui.
+    // O estado da chamada fica na pilha da thread chamadora, então um parallelFor não aloca memória.
+    void parallelFor(std::size_t count, FunctionRef<void(std::size_t)> fn);
+
+    // Divide [0, count) em faixas contíguas de pelo menos 'grain' índices (no máximo algumas por thread) e executa
+    // fn(begin, end) para cada faixa. Com poucos índices, roda uma única faixa direto na thread chamadora.
+    void parallelFor(std::size_t count, std::size_t grain, FunctionRef<void(std::size_t, std::size_t)> fn);
+
+    // Número de threads que participam de um parallelFor (trabalhadoras + chamadora)
+    std::size_t size() const;
+
+    // Pool compartilhado pelo processo inteiro. O número de threads vem de configureGlobal ou de BUMBLEBEE_NUM_THREADS
+    // (padrão: um por núcleo) e a afinidade de configureGlobal ou de BUMBLEBEE_PIN_THREADS=1 (padrão: desligada).
+    static ThreadPool& global();
+
+    // Define o número de threads (0 = um por núcleo) e a afinidade do pool global; precisa ser chamada antes do
+    // primeiro uso de global() e lança std::logic_error depois disso
+    static void configureGlobal(std::size_t num_threads, bool pin_threads);
+
+private:
+
+    // Laço principal de cada thread de trabalho
+    void workerLoop();
+
+    // Threads de trabalho
+    std::vector<std::thread> workers;
+
+    // Chamadas de parallelFor em andamento, protegidas por 'mutex'. As trabalhadoras esperam em 'task_available' por
+    // uma chamada com índices livres; as chamadoras esperam em 'job_finished' as trabalhadoras saírem da sua chamada.
+    std::vector<ParallelForJob*> jobs;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable job_finished;
+
+    // Retorna uma chamada com índices ainda não distribuídos (ou nullptr); exige 'mutex'
+    ParallelForJob* findJob() const;
+
+    // Sinaliza o encerramento das threads
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,38 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Verifica se TOKENIZED_CORPUS_H já foi definido, para evitar múltiplas inclusões
+#ifndef TOKENIZED_CORPUS_H
+
+// Define TOKENIZED_CORPUS_H se ainda não tiver sido definido
+#define TOKENIZED_CORPUS_H
+
+// Inclui a biblioteca padrão de vetores
+#include <vector>
+
+// Inclui std::span
+#include <span>
+
+// Inclui os inteiros de tamanho fixo
+#include <cstdint>
+
+// Corpus tokenizado: os IDs de todas as linhas não vazias, concatenados na ordem do texto, e o início de cada linha.
+// A linha i ocupa tokens[line_offsets[i], line_offsets[i + 1]).
+struct TokenizedCorpus {
+
+    // IDs de todas as linhas
+    std::vector<int> tokens;
+
+    // Início de cada linha em 'tokens' (line_offsets[lines()] == tokens.size())
+    std::vector<uint64_t> line_offsets{0};
+
+    // Número de linhas
+    std::size_t lines() const { return line_offsets.size() - 1; }
+
+    // IDs da linha i (sem cópia)
+    std::span<const int> line(std::size_t i) const {
+        return std::span<const int>(tokens.data() + line_offsets[i], line_offsets[i + 1] - line_offsets[i]);
+    }
+};
+
+#endif
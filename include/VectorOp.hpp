@@ -19,16 +19,130 @@
 // Inclui a biblioteca matemática padrão (para funções como sqrt, exp, etc.)
 #include <cmath>
 
+// Inclui std::max, usado pela ReLU do epílogo
+#include <algorithm>
+
+// Inclui o tipo Tensor e as views não proprietárias
+#include "Tensor.hpp"
+
+// Inclui as matrizes de pesos quantizadas em INT8
+#include "Quantization.hpp"
+
+// Função de ativação aplicada no epílogo de um GEMM
+enum class ActivationFunction {
+    None,
+
+    // max(0, x)
+    ReLU,
+
+    // Aproximação com tanh: 0.5 * x * (1 + tanh(sqrt(2 / pi) * (x + 0.044715 * x^3)))
+    GELU,
+
+    // Linear com porta: as colunas de C vêm em pares (gate, up) intercalados e cada par vira silu(gate) * up
+    SwiGLU
+};
+
+// Epílogo de um GEMM: operações por elemento aplicadas a cada bloco de C assim que ele fica pronto (ainda no cache),
+// em vez de passadas separadas sobre a matriz inteira. Na ordem: C(i, j) += bias[j], ativação e C(i, j) += residual(i, j).
+//
+// Com SwiGLU, as colunas 2p e 2p + 1 de C são o gate e o up da feature p (os pesos são guardados intercalados), e o
+// resultado silu(gate) * up (+ residual(i, p)) vai para gated(i, p), com metade das colunas de C; C fica com os valores
+// antes da ativação.
+template <typename T>
+struct GemmEpilogue {
+
+    // Bias por coluna de C (nullptr se não houver)
+    const T* bias = nullptr;
+
+    // Ativação aplicada depois do bias
+    ActivationFunction activation = ActivationFunction::None;
+
+    // Matriz somada depois da ativação, com as dimensões do resultado (vazia se não houver)
+    MatrixView<const T> residual;
+
+    // Destino do SwiGLU (linhas de C x metade das colunas de C)
+    MatrixView<T> gated;
+
+    // Indica se o epílogo faz alguma coisa
+    bool active() const { return bias != nullptr || activation != ActivationFunction::None || !residual.empty(); }
+
+    // Aplica o epílogo às colunas [j0, j0 + cols) da linha i de C, guardadas a partir de 'c'
+    void apply(std::size_t i, std::size_t j0, T* c, std::size_t cols) const {
+        if (activation == ActivationFunction::SwiGLU) {
+            T* out = &gated(i, j0 / 2);
+            const T* res = residual.empty() ? nullptr : &residual(i, j0 / 2);
+            for (std::size_t p = 0; p < cols / 2; ++p) {
+                T gate = c[2 * p];
+                T up = c[2 * p + 1];
+                if (bias != nullptr) {
+                    gate += bias[j0 + 2 * p];
+                    up += bias[j0 + 2 * p + 1];
+                }
+                T value = gate / (T(1) + std::exp(-gate)) * up;
+                out[p] = res != nullptr ? value + res[p] : value;
+            }
+            return;
+        }
+        const T* res = residual.empty() ? nullptr : &residual(i, j0);
+        for (std::size_t j = 0; j < cols; ++j) {
+            T value = c[j];
+            if (bias != nullptr) {
+                value += bias[j0 + j];
+            }
+            if (activation == ActivationFunction::ReLU) {
+                value = std::max(T(0), value);
+            } else if (activation == ActivationFunction::GELU) {
+                const T inner = T(0.7978845608028654) * (value + T(0.044715) * value * value * value);
+                value = T(0.5) * value * (T(1) + std::tanh(inner));
+            }
+            if (res != nullptr) {
+                value += res[j];
+            }
+            c[j] = value;
+        }
+    }
+};
+
 // Declaração da classe VectorMath que contém funções auxiliares para operações matriciais
 class VectorMath {
 
 public:
     
     // Função estática que realiza a multiplicação matricial (a * b)
-    static std::vector<std::vector<double>> matmul(const std::vector<std::vector<double>>& a, const std::vector<std::vector<double>>& b);
+    static Tensor matmul(ConstTensorView a, ConstTensorView b);
 
     // Função estática que realiza a transposição de uma matriz
-    static std::vector<std::vector<double>> transpose(const std::vector<std::vector<double>>& matrix);
+    static Tensor transpose(ConstTensorView matrix);
+
+    // Função estática que calcula C = alpha * A * op(B) + beta * C, onde op(B) é B ou B transposta.
+    // Usa o GEMM empacotado e bloqueado para cache, com o conjunto de instruções (AVX-512, AVX2, SSE2 ou escalar)
+    // escolhido em tempo de execução; a variável de ambiente BUMBLEBEE_GEMM_ISA força uma escolha.
+    // Existem versões em precisão simples e dupla, independentemente do tipo escalar do modelo (real_t).
+    static void gemm(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c, bool transpose_b = false, float alpha = 1.0f, float beta = 0.0f);
+    static void gemm(MatrixView<const double> a, MatrixView<const double> b, MatrixView<double> c, bool transpose_b = false, double alpha = 1.0, double beta = 0.0);
+
+    // Versões que calculam C = A * op(B) e aplicam 'epilogue' a cada bloco de C assim que ele fica pronto
+    static void gemm(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c, bool transpose_b, const GemmEpilogue<float>& epilogue);
+    static void gemm(MatrixView<const double> a, MatrixView<const double> b, MatrixView<double> c, bool transpose_b, const GemmEpilogue<double>& epilogue);
+
+    // Função estática que retorna o nome do conjunto de instruções usado pelo GEMM
+    static const char* gemmBackend();
+
+    // Função estática que calcula C = A * W^T com W quantizada em INT8 (pesos no formato saída x entrada).
+    // Cada linha de A é quantizada na hora para u8 (escala por linha, ponto zero 128), os produtos são acumulados
+    // em int32 (VNNI quando disponível) e o resultado é reescalado com as escalas de A e de cada canal de W.
+    // 'epilogue' é aplicado a cada linha de C logo depois de ela ser reescalada. A coluna j de C usa a linha
+    // first_row + j de W, então C pode cobrir só uma faixa dos canais de saída (c.cols() <= w.rows - first_row).
+    static void gemmInt8(ConstTensorView a, const QuantizedMatrix& w, TensorView c, const GemmEpilogue<real_t>& epilogue = {},
+                         std::size_t first_row = 0);
+
+    // Função estática que retorna o nome do conjunto de instruções usado pelo GEMM INT8
+    static const char* gemmInt8Backend();
+
+    // Função estática que aplica uma projeção linear (output = input * W^T), usando a versão INT8 de W quando
+    // 'quantized' não está vazia e o GEMM em ponto flutuante caso contrário, com 'epilogue' fundido nos dois casos
+    static void project(ConstTensorView input, ConstTensorView weights, const QuantizedMatrix& quantized, TensorView output,
+                        const GemmEpilogue<real_t>& epilogue = {});
 };
 
 #endif
@@ -4,6 +4,9 @@
 // Inclui o arquivo de cabeçalho onde a classe Embedding é definida
 #include "../include/01RMTAEmbedding.hpp"
 
+// Inclui std::as_const
+#include <utility>
+
 // Construtor da classe Embedding, inicializa vocab_size, embed_dim e gera a matriz de embeddings
 Embedding::Embedding(int vocab_size, int embed_dim){
 
@@ -17,7 +20,7 @@ Embedding::Embedding(int vocab_size, int embed_dim){
     this->embedding_matrix = generateRandomEmbeddingMatrix(embed_dim, vocab_size);
 
     // Exibe as dimensões da matriz de embeddings no console
-    std::cout << "Embedding matrix dims: " << embedding_matrix->size() << " x " << embedding_matrix[0].size() << std::endl;
+    std::cout << "Embedding matrix dims: " << embedding_matrix->rows() << " x " << embedding_matrix->cols() << std::endl;
 }
 
 // Função para imprimir a matriz de embeddings no console
@@ -33,7 +36,7 @@ void Embedding::printEmbeddingMatrix() {
         for (int j = 0; j < this->embed_dim; j++) {
             
             // Imprime cada valor do embedding com precisão de 2 casas decimais e largura de 6
-            std::cout << std::fixed << std::setprecision(2) << std::setw(6) << (*this->embedding_matrix)[i][j] << " ";
+            std::cout << std::fixed << std::setprecision(2) << std::setw(6) << (*this->embedding_matrix)(i, j) << " ";
         }
 
         // Pula para a próxima linha após imprimir todos os valores do token atual
@@ -63,7 +66,7 @@ void Embedding::saveEmbeddingMatrix(const std::string& filename) {
         for (int j = 0; j < this->embed_dim; j++) {
             
             // Adiciona o valor do embedding ao stringstream
-            oss << (*this->embedding_matrix)[i][j] << " ";
+            oss << (*this->embedding_matrix)(i, j) << " ";
         }
         
         // Adiciona uma nova linha após cada linha de embeddings
@@ -90,7 +93,7 @@ void Embedding::loadEmbeddingMatrix(const std::string& filename) {
     }
 
     // Redimensiona a matriz de embeddings para corresponder ao vocabulário e dimensões de embedding
-    (*this->embedding_matrix).resize(this->vocab_size, std::vector<double>(this->embed_dim, 0.0f));
+    this->embedding_matrix->resize(this->vocab_size, this->embed_dim, 0.0);
 
     // String para armazenar cada linha lida do arquivo
     std::string line;
@@ -105,14 +108,14 @@ void Embedding::loadEmbeddingMatrix(const std::string& filename) {
         std::istringstream iss(line);
         
         // Armazena o valor lido da linha
-        double value; 
+        real_t value; 
         
         // Índice da coluna atual (dimensão do embedding)
         int col = 0; 
 
         // Lê os valores da linha e armazena na matriz de embeddings
         while (iss >> value && col < this->embed_dim) {
-            (*this->embedding_matrix)[row][col] = value;
+            (*this->embedding_matrix)(row, col) = value;
             ++col;
         }
 
@@ -135,11 +138,21 @@ void Embedding::loadEmbeddingMatrix(const std::string& filename) {
     file.close();
 }
 
+// Função que salva a matriz de embeddings no checkpoint
+void Embedding::saveParameters(CheckpointWriter &writer, const std::string &prefix) const {
+    writer.addTensor(prefix + ".matrix", *this->embedding_matrix);
+}
+
+// Função que carrega a matriz de embeddings do checkpoint
+void Embedding::loadParameters(const CheckpointReader &reader, const std::string &prefix) {
+    *this->embedding_matrix = reader.tensor(prefix + ".matrix", this->vocab_size, this->embed_dim);
+}
+
 // Função que gera uma matriz de embeddings aleatória
-std::vector<std::vector<double>> *Embedding::generateRandomEmbeddingMatrix(int embed_dim, int vocab_size){
+Tensor *Embedding::generateRandomEmbeddingMatrix(int embed_dim, int vocab_size){
     
-    // Aloca a matriz de embeddings
-    std::vector<std::vector<double>>* embedding_matrix= new std::vector<std::vector<double>>(vocab_size, std::vector<double>(embed_dim, 0.0));
+    // Aloca a matriz de embeddings em um único bloco contíguo
+    Tensor* embedding_matrix = new Tensor(vocab_size, embed_dim, 0.0);
     
     // Inicializa um gerador de números aleatórios
     std::random_device rd;
@@ -155,7 +168,7 @@ std::vector<std::vector<double>> *Embedding::generateRandomEmbeddingMatrix(int e
         for (int j = 0; j < this->embed_dim; j++){
 
             // Atribui o valor aleatório ao embedding
-            (*embedding_matrix)[i][j] = dis(gen); 
+            (*embedding_matrix)(i, j) = dis(gen); 
         }
     }
 
@@ -164,27 +177,36 @@ std::vector<std::vector<double>> *Embedding::generateRandomEmbeddingMatrix(int e
 }
 
 // Função que retorna o embedding correspondente ao token_id fornecido
-std::vector<double> Embedding::getEmbedding(int token_id){
+std::span<const real_t> Embedding::getEmbedding(int token_id) const {
 
-    // Retorna o embedding do token
-    return (*this->embedding_matrix)[token_id]; 
+    // Retorna a linha da matriz correspondente ao token, sem copiar
+    return std::as_const(*this->embedding_matrix).row(token_id); 
 }
 
 // Função que converte uma lista de tokens em uma lista de embeddings
-std::vector<std::vector<double>> *Embedding::tokenToEmbeddings(std::vector<int> tokens){
-    
-    // Aloca um vetor de embeddings para os tokens fornecidos
-    std::vector<std::vector<double>>* embeddings = new std::vector<std::vector<double>>( tokens.size() , std::vector<double>(this->embed_dim, 0.0));
+Tensor *Embedding::tokenToEmbeddings(std::span<const int> tokens) const {
     
-    // Associa o embedding correspondente a cada token
-    for (int i = 0; i < tokens.size(); i++){
-        (*embeddings)[i] = (*this->embedding_matrix)[tokens[i]];
-    }
+    // Aloca a matriz de embeddings da sequência (seq_len x embed_dim) em um único bloco
+    Tensor* embeddings = new Tensor(tokens.size(), this->embed_dim);
+    tokenToEmbeddings(tokens, *embeddings);
     
     // Retorna o vetor de embeddings
     return embeddings; 
 }
 
+// Função que escreve os embeddings de uma sequência de tokens em output
+void Embedding::tokenToEmbeddings(std::span<const int> tokens, TensorView output) const {
+    if (output.rows() != tokens.size() || output.cols() != static_cast<size_t>(embed_dim)) {
+        throw std::invalid_argument("Embedding::tokenToEmbeddings: saída com dimensões incorretas.");
+    }
+
+    // Copia a linha correspondente a cada token
+    for (size_t i = 0; i < tokens.size(); i++){
+        std::span<const real_t> source = getEmbedding(tokens[i]);
+        std::copy(source.begin(), source.end(), output.row(i).begin());
+    }
+}
+
 // Destrutor da classe Embedding
 Embedding::~Embedding()
 {
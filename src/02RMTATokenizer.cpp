@@ -4,6 +4,26 @@
 // Inclui o arquivo de cabeçalho onde a classe Tokenizer é definida
 #include "../include/02RMTATokenizer.hpp"
 
+// Inclui std::memcpy
+#include <cstring>
+
+// Inclui std::copy_n e std::min
+#include <algorithm>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Inclui std::unique_ptr
+#include <memory>
+
+// Inclui o pool de threads usado na tokenização de corpus
+#include "../include/ThreadPool.hpp"
+
+// Indica se um byte é espaço em branco (mesmo critério de operator>> no locale "C")
+static bool isSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
 // Construtor da classe Tokenizer
 Tokenizer::Tokenizer(){
 
@@ -13,6 +33,18 @@ Tokenizer::Tokenizer(){
 
 // Função que transforma um texto em uma sequência de IDs de tokens
 std::vector<int> Tokenizer::tokenize(std::string text){
+
+    // No modo BPE, o vocabulário é fixo e a tokenização não o modifica
+    if (this->bpe) {
+        return this->bpe->tokenize(text);
+    }
+
+    // Com o vocabulário congelado, usa a versão somente leitura (conta os tokens e depois os escreve)
+    if (this->frozen) {
+        std::vector<int> tokens(this->frozen->tokenize(text, {}));
+        this->frozen->tokenize(text, tokens);
+        return tokens;
+    }
     
     // Vetor que armazenará os tokens (IDs)
     std::vector<int> tokens;
@@ -45,12 +77,189 @@ std::vector<int> Tokenizer::tokenize(std::string text){
     return tokens;
 }
 
+// Função que converte um texto em IDs sem modificar o tokenizador
+std::size_t Tokenizer::tokenize(std::string_view text, std::span<int> output) const{
+
+    // Modo BPE: o vocabulário já é fixo
+    if (this->bpe) {
+        std::vector<int> tokens = this->bpe->tokenize(text);
+        std::copy_n(tokens.begin(), std::min(tokens.size(), output.size()), output.begin());
+        return tokens.size();
+    }
+
+    // Modo por palavras: só é seguro depois de freeze
+    if (!this->frozen) {
+        throw std::logic_error("Tokenizer::tokenize: o vocabulário precisa estar congelado (freeze) ou no modo BPE.");
+    }
+    return this->frozen->tokenize(text, output);
+}
+
+// Função que tokeniza um corpus inteiro em paralelo
+TokenizedCorpus Tokenizer::tokenizeCorpus(std::string_view corpus, std::size_t num_threads){
+
+    // Pool usado: o global ou um criado só para esta chamada
+    std::unique_ptr<ThreadPool> local_pool;
+    if (num_threads > 0) {
+        local_pool = std::make_unique<ThreadPool>(num_threads);
+    }
+    ThreadPool& pool = local_pool ? *local_pool : ThreadPool::global();
+
+    // Divide o texto em faixas de tamanho parecido, cada uma terminando logo após um '\n'
+    const std::size_t shard_count = std::max<std::size_t>(1, std::min(pool.size(), corpus.size() / 4096 + 1));
+    std::vector<std::string_view> shard_text;
+    std::size_t begin = 0;
+    for (std::size_t s = 1; s <= shard_count && begin < corpus.size(); ++s) {
+        std::size_t end = s == shard_count ? corpus.size() : std::max(begin, corpus.size() * s / shard_count);
+        end = corpus.find('\n', end);
+        end = end == std::string_view::npos ? corpus.size() : end + 1;
+        shard_text.push_back(corpus.substr(begin, end - begin));
+        begin = end;
+    }
+
+    // Resultado de cada faixa: IDs, tamanho de cada linha e, sem vocabulário fixo, o vocabulário local
+    // (palavras na ordem de primeira ocorrência, como views sobre o próprio corpus)
+    struct Shard {
+        std::vector<int> tokens;
+        std::vector<uint64_t> line_lengths;
+        std::unordered_map<std::string_view, int> local_ids;
+        std::vector<std::string_view> local_words;
+    };
+    std::vector<Shard> shards(shard_text.size());
+    const bool building = !this->bpe && !this->frozen;
+
+    pool.parallelFor(shards.size(), [&](std::size_t s) {
+        Shard& shard = shards[s];
+        std::string_view text = shard_text[s];
+        std::vector<int> scratch;
+        std::size_t position = 0;
+        while (position < text.size()) {
+
+            // Próxima linha (sem o '\n'); linhas vazias são ignoradas, como no laço com std::getline
+            std::size_t end = text.find('\n', position);
+            end = end == std::string_view::npos ? text.size() : end;
+            std::string_view line = text.substr(position, end - position);
+            position = end + 1;
+            if (line.empty()) {
+                continue;
+            }
+            std::size_t before = shard.tokens.size();
+
+            if (this->bpe) {
+                std::vector<int> ids = this->bpe->tokenize(line);
+                shard.tokens.insert(shard.tokens.end(), ids.begin(), ids.end());
+            } else if (this->frozen) {
+                std::size_t count = this->frozen->tokenize(line, {});
+                shard.tokens.resize(before + count);
+                this->frozen->tokenize(line, std::span<int>(shard.tokens.data() + before, count));
+            } else {
+
+                // Vocabulário local: IDs provisórios, remapeados depois da combinação
+                std::size_t i = 0;
+                while (true) {
+                    while (i < line.size() && isSpace(static_cast<unsigned char>(line[i]))) {
+                        ++i;
+                    }
+                    if (i == line.size()) {
+                        break;
+                    }
+                    std::size_t word_begin = i;
+                    while (i < line.size() && !isSpace(static_cast<unsigned char>(line[i]))) {
+                        ++i;
+                    }
+                    std::string_view word = line.substr(word_begin, i - word_begin);
+                    auto [it, inserted] = shard.local_ids.emplace(word, static_cast<int>(shard.local_words.size()));
+                    if (inserted) {
+                        shard.local_words.push_back(word);
+                    }
+                    shard.tokens.push_back(it->second);
+                }
+            }
+            shard.line_lengths.push_back(shard.tokens.size() - before);
+        }
+    });
+
+    // Combina os vocabulários locais na ordem das faixas: cada palavra nova recebe o próximo ID global,
+    // exatamente como aconteceria se o corpus fosse tokenizado do início ao fim por uma única thread
+    if (building) {
+        std::vector<std::vector<int>> remap(shards.size());
+        for (std::size_t s = 0; s < shards.size(); ++s) {
+            remap[s].reserve(shards[s].local_words.size());
+            for (std::string_view word : shards[s].local_words) {
+                auto [it, inserted] = this->word_to_token_id.emplace(std::string(word), static_cast<int>(this->word_to_token_id.size()));
+                if (inserted) {
+                    this->token_id_to_word[it->second] = it->first;
+                }
+                remap[s].push_back(it->second);
+            }
+        }
+        pool.parallelFor(shards.size(), [&](std::size_t s) {
+            for (int& token : shards[s].tokens) {
+                token = remap[s][token];
+            }
+        });
+    }
+
+    // Concatena as faixas
+    TokenizedCorpus result;
+    std::vector<std::size_t> token_begin(shards.size() + 1, 0);
+    for (std::size_t s = 0; s < shards.size(); ++s) {
+        token_begin[s + 1] = token_begin[s] + shards[s].tokens.size();
+        for (uint64_t length : shards[s].line_lengths) {
+            result.line_offsets.push_back(result.line_offsets.back() + length);
+        }
+    }
+    result.tokens.resize(token_begin.back());
+    pool.parallelFor(shards.size(), [&](std::size_t s) {
+        std::copy(shards[s].tokens.begin(), shards[s].tokens.end(), result.tokens.begin() + token_begin[s]);
+    });
+    return result;
+}
+
+// Função que congela o vocabulário por palavras
+void Tokenizer::freeze(){
+
+    // Já congelado (por exemplo, carregado de um vocabulário binário)
+    if (this->frozen) {
+        return;
+    }
+
+    // Monta a lista de palavras na ordem dos IDs
+    std::vector<std::string> words(this->token_id_to_word.size());
+    for (const auto &pair : this->token_id_to_word)
+    {
+        words.at(pair.first) = pair.second;
+    }
+    this->frozen = FrozenVocab::build(words);
+
+    // Se "<unk>" foi acrescentado, ele também entra nos mapas (para detokenize e saveVocab)
+    int unk_id = this->frozen->unkId();
+    std::string unk(UNKNOWN_TOKEN);
+    this->word_to_token_id[unk] = unk_id;
+    this->token_id_to_word[unk_id] = unk;
+}
+
+// Função que treina um vocabulário BPE e passa a usá-lo
+void Tokenizer::trainBPE(const std::vector<std::string>& corpus, int vocab_size, const std::vector<std::string>& special_tokens){
+    this->bpe = BPETokenizer::train(corpus, vocab_size, special_tokens);
+    this->frozen.reset();
+    this->word_to_token_id.clear();
+    this->token_id_to_word.clear();
+}
+
 // Função que imprime o mapa de palavras para IDs de tokens
 void Tokenizer::printWordToTokenIdMap() const{
 
     // Exibe uma mensagem no console
     std::cout << "Word to Token ID Map:" << std::endl;
     
+    // Com o vocabulário congelado, as palavras vêm da arena, na ordem dos IDs
+    if (this->frozen) {
+        for (int id = 0; id < this->frozen->size(); ++id) {
+            std::cout << this->frozen->word(id) << " -> " << id << std::endl;
+        }
+        return;
+    }
+
     // Itera sobre o mapa word_to_token_id e imprime cada par palavra -> token_id
     for (const auto &pair : this->word_to_token_id)
     {
@@ -61,6 +270,16 @@ void Tokenizer::printWordToTokenIdMap() const{
 // Função que retorna o tamanho do vocabulário (número de palavras únicas)
 int Tokenizer::getVocabSize(){
 
+    // No modo BPE, o tamanho é o do vocabulário treinado
+    if (this->bpe) {
+        return this->bpe->getVocabSize();
+    }
+
+    // Com o vocabulário congelado, o tamanho é o da tabela (que pode ter sido mapeada sem preencher os mapas)
+    if (this->frozen) {
+        return this->frozen->size();
+    }
+
     // Retorna o número de entradas no mapa word_to_token_id
     return this->word_to_token_id.size();
 }
@@ -68,8 +287,22 @@ int Tokenizer::getVocabSize(){
 // Função que converte uma sequência de IDs de tokens de volta para uma string de texto
 std::string Tokenizer::detokenize(std::vector<int> tokens){
 
+    // No modo BPE, os espaços fazem parte dos tokens e o texto é a concatenação dos bytes
+    if (this->bpe) {
+        return this->bpe->detokenize(tokens);
+    }
+
     // String que armazenará o texto detokenizado
     std::string text;
+
+    // Com o vocabulário congelado, as palavras vêm direto da arena
+    if (this->frozen) {
+        for (int token : tokens) {
+            text += this->frozen->word(token);
+            text += ' ';
+        }
+        return text;
+    }
     
     // Itera sobre o vetor de tokens (IDs) e reconstrói o texto original
     for (int i = 0; i < tokens.size(); i++)
@@ -90,10 +323,22 @@ void Tokenizer::saveTokenMap(std::string filename){
     // Abre o arquivo para escrita
     file.open(filename);
     
-    // Itera sobre o mapa word_to_token_id e salva cada par palavra -> token_id no arquivo
-    for (const auto &pair : this->word_to_token_id)
+    // Com o vocabulário congelado, as palavras vêm da arena, na ordem dos IDs
+    if (this->frozen)
     {
-        file << pair.first << " " << pair.second << std::endl;
+        for (int id = 0; id < this->frozen->size(); ++id)
+        {
+            file << this->frozen->word(id) << " " << id << std::endl;
+        }
+    }
+
+    // Caso contrário, itera sobre o mapa word_to_token_id e salva cada par palavra -> token_id no arquivo
+    else
+    {
+        for (const auto &pair : this->word_to_token_id)
+        {
+            file << pair.first << " " << pair.second << std::endl;
+        }
     }
     // Fecha o arquivo após a gravação
     file.close();
@@ -105,16 +350,19 @@ void Tokenizer::loadTokenMap(std::string filename){
     // Cria um objeto de entrada de arquivo
     std::ifstream file;
     
-    // Tenta abrir o arquivo e captura exceções caso falhe
-    try
-    {
-        file.open(filename);
-    }
-    catch(const std::exception& e)
+    // Abre o arquivo para leitura (sem exceções habilitadas, a falha só aparece em is_open)
+    file.open(filename);
+
+    // Verifica se o arquivo foi aberto corretamente
+    if (!file.is_open())
     {
+        std::cerr << "Failed to open file for reading: " << filename << std::endl;
         return;
     }
     
+    // O vocabulário congelado deixa de valer
+    this->frozen.reset();
+
     // Mensagem de sucesso após carregar o mapa de tokens
     std::cout << "Loaded token map successfully" << std::endl;
     
@@ -133,22 +381,105 @@ void Tokenizer::loadTokenMap(std::string filename){
     file.close();
 }
 
+// Função que salva o vocabulário no checkpoint
+void Tokenizer::saveVocab(CheckpointWriter& writer) const {
+
+    // No modo BPE, grava as regras de fusão e os tokens especiais
+    if (this->bpe) {
+        writer.addBytes("tokenizer.bpe", this->bpe->serialize());
+        return;
+    }
+
+    // Os IDs são atribuídos em sequência (0, 1, 2, ...), então as palavras podem ser gravadas na ordem dos IDs
+    uint32_t count = static_cast<uint32_t>(this->frozen ? this->frozen->size() : this->token_id_to_word.size());
+    std::vector<uint32_t> offsets(count + 1, 0);
+    std::string chars;
+    for (uint32_t id = 0; id < count; ++id) {
+        chars += this->frozen ? this->frozen->word(id) : std::string_view(this->token_id_to_word.at(id));
+        offsets[id + 1] = static_cast<uint32_t>(chars.size());
+    }
+
+    // Monta a seção: contagem, deslocamentos e caracteres
+    std::vector<char> bytes(sizeof(count) + offsets.size() * sizeof(uint32_t) + chars.size());
+    std::memcpy(bytes.data(), &count, sizeof(count));
+    std::memcpy(bytes.data() + sizeof(count), offsets.data(), offsets.size() * sizeof(uint32_t));
+    std::memcpy(bytes.data() + sizeof(count) + offsets.size() * sizeof(uint32_t), chars.data(), chars.size());
+    writer.addBytes("tokenizer.vocab", std::move(bytes));
+}
+
+// Função que carrega o vocabulário do checkpoint, substituindo o atual
+void Tokenizer::loadVocab(const CheckpointReader& reader) {
+
+    // Checkpoint de um tokenizador BPE
+    if (reader.contains("tokenizer.bpe")) {
+        this->bpe = BPETokenizer::deserialize(reader.bytes("tokenizer.bpe"));
+        this->frozen.reset();
+        this->word_to_token_id.clear();
+        this->token_id_to_word.clear();
+        return;
+    }
+    this->bpe.reset();
+    this->frozen.reset();
+
+    std::span<const char> bytes = reader.bytes("tokenizer.vocab");
+
+    // Lê a contagem e valida o tamanho da tabela de deslocamentos
+    uint32_t count = 0;
+    if (bytes.size() < sizeof(count)) {
+        throw std::runtime_error("Tokenizer::loadVocab: seção tokenizer.vocab truncada");
+    }
+    std::memcpy(&count, bytes.data(), sizeof(count));
+    std::size_t chars_begin = sizeof(count) + (std::size_t(count) + 1) * sizeof(uint32_t);
+    if (bytes.size() < chars_begin) {
+        throw std::runtime_error("Tokenizer::loadVocab: seção tokenizer.vocab truncada");
+    }
+    std::vector<uint32_t> offsets(std::size_t(count) + 1);
+    std::memcpy(offsets.data(), bytes.data() + sizeof(count), offsets.size() * sizeof(uint32_t));
+    if (offsets[count] > bytes.size() - chars_begin) {
+        throw std::runtime_error("Tokenizer::loadVocab: seção tokenizer.vocab truncada");
+    }
+    for (uint32_t id = 0; id < count; ++id) {
+        if (offsets[id] > offsets[id + 1]) {
+            throw std::runtime_error("Tokenizer::loadVocab: seção tokenizer.vocab inválida");
+        }
+    }
+
+    // Reconstrói os dois mapas
+    this->word_to_token_id.clear();
+    this->token_id_to_word.clear();
+    for (uint32_t id = 0; id < count; ++id) {
+        std::string word(bytes.data() + chars_begin + offsets[id], offsets[id + 1] - offsets[id]);
+        this->word_to_token_id[word] = id;
+        this->token_id_to_word[id] = std::move(word);
+    }
+}
+
+// Função que salva o vocabulário congelado no formato binário
+void Tokenizer::saveBinaryVocab(const std::string& filename) const {
+    if (!this->frozen) {
+        throw std::logic_error("Tokenizer::saveBinaryVocab: o vocabulário precisa estar congelado (freeze).");
+    }
+    this->frozen->save(filename);
+}
+
+// Função que carrega um vocabulário binário com mmap, sem reconstruir os mapas
+void Tokenizer::loadBinaryVocab(const std::string& filename) {
+    this->frozen = FrozenVocab::load(filename);
+    this->bpe.reset();
+    this->word_to_token_id.clear();
+    this->token_id_to_word.clear();
+}
+
 // Função que gera uma codificação one-hot para um token específico
-std::vector<std::vector<double>> Tokenizer::oneHotEncode(int token_id) {
-    
-    // Cria um vetor que armazenará a codificação one-hot
-    std::vector<std::vector<double>> oneHotLabels;
+Tensor Tokenizer::oneHotEncode(int token_id) {
     
-    // Cria um vetor preenchido com zeros, com o tamanho igual ao vocabulário
-    std::vector<double> oneHotLabel(this->word_to_token_id.size(), 0);
+    // Cria uma matriz 1 x vocab_size preenchida com zeros
+    Tensor oneHotLabels(1, getVocabSize(), 0.0);
     
     // Define o valor 1 na posição correspondente ao token_id
-    oneHotLabel[token_id] = 1;
-    
-    // Adiciona a codificação one-hot gerada ao vetor de rótulos
-    oneHotLabels.push_back(oneHotLabel);
+    oneHotLabels(0, token_id) = 1;
 
-    // Retorna o vetor de codificações one-hot
+    // Retorna a codificação one-hot
     return oneHotLabels;
 }
 
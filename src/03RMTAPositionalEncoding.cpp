@@ -8,7 +8,7 @@
 PositionalEncoding::PositionalEncoding(int max_seq_len, int model_dim) : max_seq_len(max_seq_len), model_dim(model_dim){
     
     // Redimensiona a matriz de codificação para o tamanho da sequência máxima e a dimensão do modelo
-    encoding_matrix.resize(max_seq_len, std::vector<double>(model_dim));
+    encoding_matrix.resize(max_seq_len, model_dim);
     
     // Itera sobre cada posição da sequência
     for (int pos = 0; pos < max_seq_len; ++pos)
@@ -20,19 +20,19 @@ PositionalEncoding::PositionalEncoding(int max_seq_len, int model_dim) : max_seq
             double position = pos / std::pow(10000.0, 2.0 * i / model_dim);
             
             // Atribui o valor do seno para a posição atual e dimensão par
-            encoding_matrix[pos][i] = std::sin(position);
+            encoding_matrix(pos, i) = std::sin(position);
             
             // Se houver uma próxima dimensão, atribui o valor do cosseno à dimensão ímpar
             if (i + 1 < model_dim)
             {
-                encoding_matrix[pos][i + 1] = std::cos(position);
+                encoding_matrix(pos, i + 1) = std::cos(position);
             }
         }
     }
 }
 
 // Função que retorna a codificação posicional para uma posição específica
-const std::vector<double>& PositionalEncoding::getEncoding(int pos){
+std::span<const real_t> PositionalEncoding::getEncoding(int pos) const {
     
     // Verifica se a posição está dentro do intervalo permitido
     if (pos < 0 || pos >= max_seq_len)
@@ -42,29 +42,34 @@ const std::vector<double>& PositionalEncoding::getEncoding(int pos){
     }
     
     // Retorna a codificação posicional para a posição especificada
-    return encoding_matrix[pos];
+    return encoding_matrix.row(pos);
 }
 
 // Função que aplica a codificação posicional aos embeddings fornecidos
-std::vector<std::vector<double>> *PositionalEncoding::getEncodings(std::vector<std::vector<double>> &embeddings){
+Tensor *PositionalEncoding::getEncodings(const Tensor &embeddings) const {
     
-    // Determina o comprimento da sequência como o menor valor entre o tamanho dos embeddings e a matriz de codificação
-    int seq_len = std::min(embeddings.size(), encoding_matrix.size());
-    
-    // Aloca memória para armazenar as codificações finais
-    std::vector<std::vector<double>> *encodings = new std::vector<std::vector<double>>(seq_len, std::vector<double>(this->model_dim));
+    // Aloca memória para armazenar as codificações finais (o comprimento é limitado pela matriz de codificação)
+    Tensor *encodings = new Tensor(encodedLength(embeddings.rows()), this->model_dim);
+    getEncodings(embeddings, *encodings);
     
+    // Retorna o ponteiro para as codificações finais
+    return encodings;
+}
+
+// Função que aplica a codificação posicional escrevendo em output
+void PositionalEncoding::getEncodings(ConstTensorView embeddings, TensorView output) const {
+    if (output.rows() != encodedLength(embeddings.rows()) || output.cols() != static_cast<size_t>(model_dim)) {
+        throw std::invalid_argument("PositionalEncoding::getEncodings: saída com dimensões incorretas.");
+    }
+
     // Itera sobre cada posição da sequência
-    for (int i = 0; i < seq_len; ++i)
+    for (size_t i = 0; i < output.rows(); ++i)
     {
         // Itera sobre cada dimensão do embedding
         for (int j = 0; j < model_dim; ++j)
         {
             // Soma o valor da codificação posicional ao valor original do embedding
-            (*encodings)[i][j] = embeddings[i][j] + encoding_matrix[i][j];
+            output(i, j) = embeddings(i, j) + encoding_matrix(i, j);
         }
     }
-    
-    // Retorna o ponteiro para as codificações finais
-    return encodings;
 }
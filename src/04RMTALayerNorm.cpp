@@ -6,6 +6,12 @@
 // Inclui o arquivo de cabeçalho onde a classe LayerNorm é definida
 #include "../include/04RMTALayerNorm.hpp"
 
+// Inclui o pool de threads, que divide as linhas de um bloco entre os núcleos
+#include "../include/ThreadPool.hpp"
+
+// Inclui std::atomic, usado para sinalizar linhas com NaN a partir das threads
+#include <atomic>
+
 // Construtor da classe LayerNorm, inicializa os vetores gamma e beta
 LayerNorm::LayerNorm(int model_dim) : model_dim(model_dim) { 
 
@@ -16,40 +22,125 @@ LayerNorm::LayerNorm(int model_dim) : model_dim(model_dim) {
     beta.resize(model_dim, 0.0f); 
 }
 
-// Função que aplica a normalização de camada em um vetor de entrada
-std::vector<double> LayerNorm::normalize(const std::vector<double>& input) const {
-    
-    // Calcula a média dos valores de entrada
-    double mean = std::accumulate(input.begin(), input.end(), 0.0f) / input.size();
+// Número de acumuladores independentes de média e variância em cada linha (uma largura de vetor SIMD)
+static constexpr std::size_t MOMENT_LANES = 8;
+
+// Define um pequeno valor para evitar divisão por zero
+static constexpr double LAYER_NORM_EPSILON = 1e-5;
 
-    // Calcula a variância
-    double variance = 0.0f;
+// Média e variância de uma linha
+struct RowMoments {
+    double mean = 0.0;
+    double variance = 0.0;
+};
 
-    for (double val : input) {
+// Função que calcula média e variância de uma linha em uma única passada (Welford). Cada um dos MOMENT_LANES
+// acumuladores segue o seu próprio Welford sobre os elementos i com i % MOMENT_LANES igual ao seu índice, então o laço
+// interno não tem dependência entre os acumuladores e pode ser vetorizado; no fim, eles são combinados com a fórmula de
+// Chan. 'load(i)' retorna o i-ésimo valor da linha (e pode gravá-lo em outro lugar no caminho).
+template <typename Load>
+static RowMoments rowMoments(std::size_t n, Load&& load) {
+    double mean[MOMENT_LANES] = {};
+    double m2[MOMENT_LANES] = {};
+    const std::size_t groups = n / MOMENT_LANES;
 
-        // Soma dos quadrados das diferenças em relação à média
-        variance += (val - mean) * (val - mean); 
+    // Grupos completos: todos os acumuladores recebem o (k + 1)-ésimo valor
+    for (std::size_t k = 0; k < groups; ++k) {
+        const double inv_count = 1.0 / static_cast<double>(k + 1);
+        for (std::size_t l = 0; l < MOMENT_LANES; ++l) {
+            const double x = load(k * MOMENT_LANES + l);
+            const double delta = x - mean[l];
+            mean[l] += delta * inv_count;
+            m2[l] += delta * (x - mean[l]);
+        }
     }
-    
-    // Divide pelo número de elementos para obter a variância
-    variance /= input.size(); 
 
-    // Define um pequeno valor para evitar divisão por zero
-    const double epsilon = 1e-5; 
-    
-    // Vetor para armazenar o resultado normalizado
-    std::vector<double> normalized(input.size());
-
-    // Aplica a normalização para cada elemento do vetor de entrada
-    for (size_t i = 0; i < input.size(); ++i) {
-        
-        // Normaliza o valor subtraindo a média e dividindo pelo desvio padrão
-        normalized[i] = (input[i] - mean) / std::sqrt(variance + epsilon);
-        
-        // Aplica a escala gamma e o deslocamento beta
-        normalized[i] = gamma[0] * normalized[i] + beta[0]; // Nota: gamma[0] e beta[0] são constantes aqui
+    // Resto da linha: os primeiros acumuladores recebem um valor a mais
+    const std::size_t rest = n - groups * MOMENT_LANES;
+    const double inv_count = 1.0 / static_cast<double>(groups + 1);
+    for (std::size_t l = 0; l < rest; ++l) {
+        const double x = load(groups * MOMENT_LANES + l);
+        const double delta = x - mean[l];
+        mean[l] += delta * inv_count;
+        m2[l] += delta * (x - mean[l]);
+    }
+
+    // Combina os acumuladores (Chan): cada um tem 'groups' ou 'groups + 1' valores
+    double count = 0.0;
+    RowMoments moments;
+    double total_m2 = 0.0;
+    for (std::size_t l = 0; l < MOMENT_LANES; ++l) {
+        const double lane_count = static_cast<double>(groups + (l < rest ? 1 : 0));
+        if (lane_count == 0.0) {
+            continue;
+        }
+        const double merged = count + lane_count;
+        const double delta = mean[l] - moments.mean;
+        moments.mean += delta * lane_count / merged;
+        total_m2 += m2[l] + delta * delta * count * lane_count / merged;
+        count = merged;
+    }
+    moments.variance = count > 0.0 ? total_m2 / count : 0.0;
+    return moments;
+}
+
+// Função que normaliza 'values' com os momentos dados, aplicando gamma e beta de cada feature, escrevendo em output
+static void applyNormalization(const real_t* values, real_t* output, std::size_t n, RowMoments moments,
+                               const real_t* gamma, const real_t* beta) {
+
+    // (x - média) / desvio padrão vira x * scale + shift
+    const double inv_std = 1.0 / std::sqrt(moments.variance + LAYER_NORM_EPSILON);
+    const real_t scale = static_cast<real_t>(inv_std);
+    const real_t shift = static_cast<real_t>(-moments.mean * inv_std);
+    for (std::size_t i = 0; i < n; ++i) {
+        output[i] = gamma[i] * (values[i] * scale + shift) + beta[i];
     }
+}
+
+// Função que aplica a normalização de camada em um vetor de entrada
+void LayerNorm::normalize(std::span<const real_t> input, std::span<real_t> output) const {
+
+    // Primeira passada: média e variância; segunda: normalização com gamma e beta de cada feature
+    const real_t* values = input.data();
+    RowMoments moments = rowMoments(input.size(), [values](std::size_t i) { return values[i]; });
+    applyNormalization(values, output.data(), input.size(), moments, gamma.data(), beta.data());
+}
+
+// Função que aplica a soma residual e a normalização de camada em um bloco de posições
+bool LayerNorm::addNormalize(ConstTensorView residual, ConstTensorView input, TensorView output) const {
+    const std::size_t n = output.cols();
+    std::atomic<bool> finite{true};
+    ThreadPool::global().parallelFor(output.rows(), ROW_PARALLEL_GRAIN, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t r = begin; r < end; ++r) {
+            const real_t* a = residual.row(r).data();
+            const real_t* b = input.row(r).data();
+            real_t* out = output.row(r).data();
+
+            // Primeira passada: a soma é gravada em output enquanto média e variância são acumuladas
+            RowMoments moments = rowMoments(n, [a, b, out](std::size_t i) {
+                const real_t sum = a[i] + b[i];
+                out[i] = sum;
+                return sum;
+            });
+            if (std::isnan(moments.mean) || std::isnan(moments.variance)) {
+                finite.store(false, std::memory_order_relaxed);
+            }
+
+            // Segunda passada: normaliza a soma no próprio output
+            applyNormalization(out, out, n, moments, gamma.data(), beta.data());
+        }
+    });
+    return finite.load(std::memory_order_relaxed);
+}
+
+// Função que salva gamma e beta no checkpoint
+void LayerNorm::saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+    writer.addVector(prefix + ".gamma", gamma);
+    writer.addVector(prefix + ".beta", beta);
+}
 
-    // Retorna o vetor normalizado
-    return normalized;
+// Função que carrega gamma e beta do checkpoint
+void LayerNorm::loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+    gamma = reader.vector(prefix + ".gamma", model_dim);
+    beta = reader.vector(prefix + ".beta", model_dim);
 }
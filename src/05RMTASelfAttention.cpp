@@ -4,8 +4,18 @@
 // Inclui o arquivo de cabeçalho onde a classe SelfAttention é definida
 #include "../include/05RMTASelfAttention.hpp"
 
-// Construtor da classe SelfAttention, inicializa os pesos W_q, W_k e W_v aleatoriamente
-SelfAttention::SelfAttention(int model_dim) : model_dim(model_dim) {
+// Tamanho dos blocos de queries e keys do kernel Flash: o bloco de scores (32 x 128 valores) fica no L1/L2
+static constexpr size_t FLASH_ATTENTION_BLOCK_QUERIES = 32;
+static constexpr size_t FLASH_ATTENTION_BLOCK_KEYS = 128;
+
+// Construtor da classe SelfAttention, inicializa os pesos W_q, W_k e W_v (e W_o, com várias cabeças) aleatoriamente
+SelfAttention::SelfAttention(int model_dim, int num_heads) : model_dim(model_dim), num_heads(num_heads) {
+
+    // Cada cabeça recebe uma fatia igual das model_dim colunas
+    if (num_heads < 1 || model_dim % num_heads != 0) {
+        throw std::invalid_argument("SelfAttention: model_dim deve ser divisível por num_heads.");
+    }
+    head_dim = model_dim / num_heads;
     
     // Gera números aleatórios
     std::random_device rd;
@@ -17,16 +27,19 @@ SelfAttention::SelfAttention(int model_dim) : model_dim(model_dim) {
     // Cria uma distribuição uniforme entre -range e range
     std::uniform_real_distribution<> distr(-range, range);
 
-    // Inicializa as matrizes de pesos W_q, W_k, W_v com valores aleatórios
-    for (auto* weight_matrix : {&W_q, &W_k, &W_v}) {
+    // A projeção de saída só existe quando há mais de uma cabeça
+    std::vector<Tensor*> weight_matrices = {&W_q, &W_k, &W_v};
+    if (num_heads > 1) {
+        weight_matrices.push_back(&W_o);
+    }
 
-        // Redimensiona cada matriz de pesos
-        weight_matrix->resize(model_dim);  
-        for (auto& row : *weight_matrix) {
+    // Inicializa as matrizes de pesos com valores aleatórios
+    for (auto* weight_matrix : weight_matrices) {
 
-            // Redimensiona cada linha da matriz
-            row.resize(model_dim);  
-            for (auto& elem : row) {
+        // Redimensiona cada matriz de pesos (um único bloco model_dim x model_dim)
+        weight_matrix->resize(model_dim, model_dim);  
+        for (size_t i = 0; i < weight_matrix->rows(); ++i) {
+            for (auto& elem : weight_matrix->row(i)) {
 
                 // Atribui um valor aleatório a cada elemento
                 elem = distr(gen);  
@@ -35,98 +48,378 @@ SelfAttention::SelfAttention(int model_dim) : model_dim(model_dim) {
     }
 }
 
-// Função que realiza o forward pass da self-attention
-std::vector<double> SelfAttention::forward(const std::vector<double>& input) const {
-    
-    // Computa as queries (Q), keys (K) e values (V) aplicando as matrizes de pesos
-    auto Q = this->multiply(W_q, input);
-    auto K = this->multiply(W_k, input);
-    auto V = this->multiply(W_v, input);
-    
-    // Verifica se algum valor de Q, K ou V contém NaN (Not a Number)
-    if (Utils::containsNaN(Q) || Utils::containsNaN(K) || Utils::containsNaN(V)) {
-        for (auto x : Q) {
-            std::cout << x << " ";
-        }
-        std::cout << std::endl;
-        for (auto x : K) {
-            std::cout << x << " ";
-        }
-        std::cout << std::endl;
-        for (auto x : V) {
-            std::cout << x << " ";
+// Função que realiza o forward pass da self-attention sobre a sequência inteira
+Tensor SelfAttention::forward(const Tensor& input) const {
+
+    // Uma sequência só é um lote de tamanho 1
+    return forward(input, BatchLayout::single(input.rows()));
+}
+
+// Função que realiza o forward pass da self-attention sobre um lote de sequências
+Tensor SelfAttention::forward(const Tensor& input, const BatchLayout& layout) const {
+    Tensor output(input.rows(), model_dim);
+    forward(input, layout, output, ActivationArena::local());
+    return output;
+}
+
+// Função que realiza o forward pass da self-attention sobre um lote, escrevendo em output
+void SelfAttention::forward(ConstTensorView input, const BatchLayout& layout, TensorView output, ActivationArena& arena) const {
+    ActivationArena::Scope scope(arena);
+
+    // Computa as queries (Q), keys (K) e values (V) de todas as posições e de todas as cabeças com três multiplicações
+    // de matrizes (as projeções tratam o lote inteiro como uma única matriz)
+    TensorView Q = arena.allocate(input.rows(), model_dim);
+    TensorView K = arena.allocate(input.rows(), model_dim);
+    TensorView V = arena.allocate(input.rows(), model_dim);
+    VectorMath::project(input, W_q, W_q_int8, Q);
+    VectorMath::project(input, W_k, W_k_int8, K);
+    VectorMath::project(input, W_v, W_v_int8, V);
+
+    // Cada sequência atende apenas a si mesma
+    attend(Q, K, V, layout, layout, output, arena);
+}
+
+// Função que calcula a atenção de todas as cabeças a partir de Q, K e V já projetados
+Tensor SelfAttention::attend(ConstTensorView Q, ConstTensorView K, ConstTensorView V) const {
+
+    // Uma sequência só é um lote de tamanho 1
+    Tensor output(Q.rows(), model_dim);
+    attend(Q, K, V, BatchLayout::single(Q.rows()), BatchLayout::single(K.rows()), output, ActivationArena::local());
+    return output;
+}
+
+// Função que calcula a atenção de um lote de sequências a partir de Q, K e V já projetados
+void SelfAttention::attend(ConstTensorView Q, ConstTensorView K, ConstTensorView V, const BatchLayout& query_layout,
+                           const BatchLayout& key_layout, TensorView output, ActivationArena& arena) const {
+    if (query_layout.size() != key_layout.size() || Q.rows() != query_layout.rows() || K.rows() != key_layout.rows() ||
+        output.rows() != Q.rows()) {
+        throw std::invalid_argument("SelfAttention::attend: dimensões incompatíveis com o lote.");
+    }
+    ActivationArena::Scope scope(arena);
+
+    // O padding das queries fica zerado; o das keys nunca é lido, porque cada tarefa só enxerga as linhas do seu
+    // segmento. Calcular a atenção segmento a segmento equivale à máscara bloco-diagonal, sem os blocos mascarados.
+    // Com uma única cabeça, as cabeças já são a saída.
+    TensorView heads = num_heads == 1 ? output : arena.allocate(Q.rows(), model_dim);
+    for (size_t i = 0; i < heads.rows(); ++i) {
+        std::fill(heads.row(i).begin(), heads.row(i).end(), real_t(0));
+    }
+
+    // Cada par (exemplo, cabeça) lê e escreve apenas o seu bloco de linhas e colunas, então todos rodam em paralelo.
+    // Com máscara causal, a posição t de um segmento enxerga apenas as posições 0..t do mesmo segmento.
+    ThreadPool::global().parallelFor(query_layout.size() * num_heads, [&](size_t task) {
+        const size_t b = task / num_heads;
+        const size_t col = (task % num_heads) * head_dim;
+        const size_t num_queries = query_layout.length(b);
+        const size_t num_keys = key_layout.length(b);
+        if (num_queries == 0 || num_keys == 0) {
+            return;
         }
-        std::cout << std::endl;
+        const size_t q0 = query_layout.offset(b);
+        const size_t k0 = key_layout.offset(b);
+        attendHead(Q.block(q0, num_queries, col, head_dim), K.block(k0, num_keys, col, head_dim),
+                   V.block(k0, num_keys, col, head_dim), heads.block(q0, num_queries, col, head_dim));
+    });
+    if (num_heads == 1) {
+        return;
     }
 
-    // Calcula o produto escalar entre Q e K, e ajusta pelo fator de escala
-    double score = std::inner_product(Q.begin(), Q.end(), K.begin(), 0.0f) / std::sqrt(model_dim);
-    
-    // Verifica se o score calculado é NaN
-    if (std::isnan(score)) {
-        std::cout << "Score: " << score << std::endl;
-    } 
+    // Concatena as cabeças (já lado a lado em 'heads') e aplica a projeção de saída ao lote inteiro
+    VectorMath::project(heads, W_o, W_o_int8, output);
+}
+
+// Função que calcula a atenção de uma cabeça, com o kernel escolhido
+void SelfAttention::attendHead(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const {
+    bool flash = kernel == AttentionKernel::Flash || (kernel == AttentionKernel::Auto && k.rows() > FLASH_ATTENTION_MIN_KEYS);
+    if (flash) {
+        attendHeadFlash(q, k, v, output);
+    } else {
+        attendHeadStandard(q, k, v, output);
+    }
+}
+
+// Função que calcula a atenção de uma cabeça materializando a matriz de scores
+void SelfAttention::attendHeadStandard(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const {
 
-    // Calcula o peso da atenção usando a função exponencial no score (operação softmax)
-    double attention_weight = std::exp(score) / std::exp(score); 
+    // Calcula os scores de atenção entre todas as posições (seq_len x seq_len), em memória temporária da thread
+    ActivationArena& scratch = ActivationArena::local();
+    ActivationArena::Scope scope(scratch);
+    TensorView scores = scratch.allocate(q.rows(), k.rows());
+    VectorMath::gemm(q, k, scores, true, real_t(1) / std::sqrt(static_cast<real_t>(q.cols())));
 
-    // Verifica se o peso da atenção é NaN e corrige para 1
-    if (std::isnan(attention_weight)) {
-        attention_weight = 1;
+    // Com máscara causal, a query i (alinhada ao fim das keys) não enxerga keys posteriores
+    if (causal) {
+        const size_t offset = k.rows() - q.rows();
+        for (size_t i = 0; i < scores.rows(); ++i) {
+            std::span<real_t> row = scores.row(i);
+            std::fill(row.begin() + std::min(row.size(), i + offset + 1), row.end(), -std::numeric_limits<real_t>::infinity());
+        }
+    }
+
+    // Aplica a softmax numericamente estável em cada linha: cada posição distribui sua atenção entre todas as posições
+    for (size_t i = 0; i < scores.rows(); ++i) {
+        Utils::softmaxInPlace(scores.row(i));
     }
 
-    // Verifica novamente se há NaN em Q, K, V, score ou attention_weight
-    if (std::isnan(attention_weight)) {
-        for (auto x : Q) {
-            std::cout << x << " ";
+    // Calcula a saída como a média ponderada dos values: softmax(q k^T / sqrt(d)) * v
+    VectorMath::gemm(scores, v, output);
+}
+
+// Função que calcula a atenção de uma cabeça em blocos, com softmax online (estilo FlashAttention)
+void SelfAttention::attendHeadFlash(ConstTensorView q, ConstTensorView k, ConstTensorView v, TensorView output) const {
+    const size_t num_queries = q.rows();
+    const size_t num_keys = k.rows();
+    const real_t scale = real_t(1) / std::sqrt(static_cast<real_t>(q.cols()));
+
+    // Com máscara causal, a query i enxerga as keys 0..i + offset (queries alinhadas ao fim das keys)
+    const size_t offset = num_keys - num_queries;
+
+    // Buffers do tamanho de um bloco, em memória temporária da thread: scores/probabilidades, máximo e soma
+    // acumulados de cada query
+    ActivationArena& scratch = ActivationArena::local();
+    ActivationArena::Scope scope(scratch);
+    TensorView block_scores = scratch.allocate(FLASH_ATTENTION_BLOCK_QUERIES, FLASH_ATTENTION_BLOCK_KEYS);
+    std::span<real_t> row_max = scratch.allocate(1, FLASH_ATTENTION_BLOCK_QUERIES).row(0);
+    std::span<real_t> row_sum = scratch.allocate(1, FLASH_ATTENTION_BLOCK_QUERIES).row(0);
+
+    // Percorre as queries em blocos; a saída do bloco acumula direto em output
+    for (size_t i0 = 0; i0 < num_queries; i0 += FLASH_ATTENTION_BLOCK_QUERIES) {
+        const size_t rows = std::min(FLASH_ATTENTION_BLOCK_QUERIES, num_queries - i0);
+        ConstTensorView q_block = q.rowRange(i0, rows);
+        TensorView out_block = output.rowRange(i0, rows);
+
+        // Estado inicial da softmax online
+        std::fill(row_max.begin(), row_max.end(), -std::numeric_limits<real_t>::infinity());
+        std::fill(row_sum.begin(), row_sum.end(), 0.0);
+        for (size_t r = 0; r < rows; ++r) {
+            std::fill(out_block.row(r).begin(), out_block.row(r).end(), 0.0);
         }
-        std::cout << std::endl;
-        for (auto x : K) {
-            std::cout << x << " ";
+
+        // Com máscara causal, os blocos de keys depois da última query do bloco são pulados inteiros
+        const size_t key_end = causal ? std::min(num_keys, i0 + rows + offset) : num_keys;
+
+        // Percorre K/V em blocos
+        for (size_t j0 = 0; j0 < key_end; j0 += FLASH_ATTENTION_BLOCK_KEYS) {
+            const size_t cols = std::min(FLASH_ATTENTION_BLOCK_KEYS, key_end - j0);
+            TensorView scores = block_scores.block(0, rows, 0, cols);
+
+            // Scores do bloco: q_block k_block^T / sqrt(d)
+            VectorMath::gemm(q_block, k.rowRange(j0, cols), scores, true, scale);
+
+            for (size_t r = 0; r < rows; ++r) {
+                std::span<real_t> s = scores.row(r);
+
+                // Mascara as keys posteriores à query (o primeiro bloco sempre tem ao menos uma key visível)
+                if (causal) {
+                    const size_t visible = i0 + r + offset + 1;
+                    for (size_t c = (visible > j0 ? visible - j0 : 0); c < cols; ++c) {
+                        s[c] = -std::numeric_limits<real_t>::infinity();
+                    }
+                }
+
+                // Novo máximo da linha e fator de correção do que já foi acumulado
+                real_t new_max = std::max(row_max[r], *std::max_element(s.begin(), s.end()));
+                real_t correction = std::exp(row_max[r] - new_max);
+                row_max[r] = new_max;
+
+                // Converte os scores do bloco em pesos não normalizados e acumula a soma
+                real_t block_sum = 0;
+                for (real_t& value : s) {
+                    value = std::exp(value - new_max);
+                    block_sum += value;
+                }
+                row_sum[r] = row_sum[r] * correction + block_sum;
+
+                // Reescala a saída acumulada para o novo máximo
+                if (correction != 1.0) {
+                    for (real_t& value : out_block.row(r)) {
+                        value *= correction;
+                    }
+                }
+            }
+
+            // Acumula os values do bloco ponderados pelos pesos: out += P v_block
+            VectorMath::gemm(scores, v.rowRange(j0, cols), out_block, false, 1.0, 1.0);
         }
-        std::cout << std::endl;
-        for (auto x : V) {
-            std::cout << x << " ";
+
+        // Normaliza cada linha pela soma total dos pesos
+        for (size_t r = 0; r < rows; ++r) {
+            for (real_t& value : out_block.row(r)) {
+                value /= row_sum[r];
+            }
         }
-        std::cout << std::endl;
-        std::cout << "Score: " << score << std::endl;
-        std::cout << "Attention weight: " << attention_weight << std::endl;
     }
+}
+
+// Função que processa uma única nova posição usando o cache de keys/values
+void SelfAttention::step(ConstTensorView input, KVCache &cache, AttentionScratch &scratch, TensorView output) const {
+    
+    // O cache é pré-alocado; passar do limite indica max_seq_len pequeno demais
+    if (cache.length >= cache.capacity()) {
+        throw std::length_error("SelfAttention::step: KV cache cheio (aumente max_seq_len).");
+    }
+    const size_t position = cache.length;
+
+    // Projeta q da nova posição e escreve k e v direto na próxima linha livre do cache
+    VectorMath::project(input, W_q, W_q_int8, scratch.query);
+    VectorMath::project(input, W_k, W_k_int8, cache.keys.block(position, 1, 0, model_dim));
+    VectorMath::project(input, W_v, W_v_int8, cache.values.block(position, 1, 0, model_dim));
+    cache.length = position + 1;
+
+    // A nova posição é a última, então enxerga todo o cache (a máscara causal é automática)
+    attendCached(cache, scratch, output);
+}
+
+// Função que processa uma única nova posição contra keys/values fixos (cross-attention na decodificação incremental)
+void SelfAttention::crossStep(ConstTensorView input, const KVCache &memory, AttentionScratch &scratch, TensorView output) const {
+
+    // Só a query é projetada; keys e values do encoder já estão no cache
+    VectorMath::project(input, W_q, W_q_int8, scratch.query);
+    attendCached(memory, scratch, output);
+}
 
-    // Calcula a saída final multiplicando o valor V pelo peso da atenção
-    std::vector<double> output(model_dim);
-    for (int i = 0; i < model_dim; ++i) {
+// Função que atende a query em scratch.query a todas as posições válidas do cache
+void SelfAttention::attendCached(const KVCache &cache, AttentionScratch &scratch, TensorView output) const {
+    const size_t length = cache.length;
+    if (length > scratch.scores.cols()) {
+        throw std::length_error("SelfAttention: buffer de scores menor que o cache.");
+    }
+    const real_t scale = real_t(1) / std::sqrt(static_cast<real_t>(head_dim));
+    TensorView scores = scratch.scores.block(0, 1, 0, length);
 
-        // Atribui o valor ponderado ao output
-        output[i] = attention_weight * V[i]; 
+    // Cada cabeça: scores contra as keys em cache, softmax e média ponderada dos values em cache.
+    // Com uma única query o trabalho por cabeça é pequeno, então as cabeças rodam em sequência.
+    for (int h = 0; h < num_heads; ++h) {
+        const size_t col = h * head_dim;
+        VectorMath::gemm(scratch.query.block(0, 1, col, head_dim), cache.keys.block(0, length, col, head_dim), scores, true, scale);
+        Utils::softmaxInPlace(scores.row(0));
+        VectorMath::gemm(scores, cache.values.block(0, length, col, head_dim), scratch.heads.block(0, 1, col, head_dim));
     }
 
-    // Retorna o resultado final da atenção
-    return output; 
+    // Aplica a projeção de saída (ou copia, com uma única cabeça)
+    if (num_heads > 1) {
+        VectorMath::project(scratch.heads, W_o, W_o_int8, output);
+    } else {
+        std::copy(scratch.heads.row(0).begin(), scratch.heads.row(0).end(), output.row(0).begin());
+    }
 }
 
-// Função que realiza a multiplicação de uma matriz por um vetor
-std::vector<double> SelfAttention::multiply(const std::vector<std::vector<double>>& matrix, const std::vector<double>& vector) const {
+// Função que projeta todas as posições da sequência com uma matriz de pesos
+Tensor SelfAttention::multiply(const Tensor& input, ConstTensorView matrix) const {
     
-    // Inicializa o vetor de resultado com zeros
-    std::vector<double> result(matrix.size(), 0.0f);
-    
-    // Realiza a multiplicação matriz-vetor
-    for (size_t i = 0; i < matrix.size(); ++i) {
-        for (size_t j = 0; j < vector.size(); ++j) {
+    // Calcula result = input * matrix^T com o GEMM (cada linha de matrix é um neurônio de saída)
+    Tensor result(input.rows(), matrix.rows());
+    VectorMath::gemm(input, matrix, result, true);
+
+    // Retorna a matriz resultante
+    return result; 
+}
+
+// Função que projeta todas as posições com uma das matrizes de pesos da atenção, em INT8 quando quantizada
+Tensor SelfAttention::multiply(ConstTensorView input, const Tensor& weights, const QuantizedMatrix& quantized) const {
+    Tensor result(input.rows(), model_dim);
+    VectorMath::project(input, weights, quantized, result);
+    return result;
+}
 
-            // Soma o produto de cada elemento
-            result[i] += matrix[i][j] * vector[j]; 
+// Função que quantiza as matrizes de pesos em INT8 e libera as versões em ponto flutuante
+void SelfAttention::quantizeWeights() {
+    for (auto [weights, quantized] : {std::pair{&W_q, &W_q_int8}, {&W_k, &W_k_int8}, {&W_v, &W_v_int8}, {&W_o, &W_o_int8}}) {
+        if (!weights->empty()) {
+            *quantized = QuantizedMatrix::quantize(*weights);
+            *weights = Tensor();
         }
     }
+}
 
-    // Retorna o vetor resultante
-    return result; 
+// Função que retorna a memória ocupada pelas matrizes de pesos
+size_t SelfAttention::weightBytes() const {
+    size_t bytes = 0;
+    for (auto [weights, quantized] : {std::pair{&W_q, &W_q_int8}, {&W_k, &W_k_int8}, {&W_v, &W_v_int8}, {&W_o, &W_o_int8}}) {
+        bytes += weights->size() * sizeof(real_t) + quantized->bytes();
+    }
+    return bytes;
+}
+
+// Função que salva as matrizes de pesos no checkpoint
+void SelfAttention::saveParameters(CheckpointWriter &writer, const std::string &prefix) const {
+    if (isQuantized()) {
+        throw std::logic_error("SelfAttention::saveParameters: pesos quantizados não podem ser salvos.");
+    }
+    writer.addTensor(prefix + ".W_q", W_q);
+    writer.addTensor(prefix + ".W_k", W_k);
+    writer.addTensor(prefix + ".W_v", W_v);
+    if (num_heads > 1) {
+        writer.addTensor(prefix + ".W_o", W_o);
+    }
+}
+
+// Função que carrega as matrizes de pesos do checkpoint (descartando uma eventual versão INT8)
+void SelfAttention::loadParameters(const CheckpointReader &reader, const std::string &prefix) {
+    W_q = reader.tensor(prefix + ".W_q", model_dim, model_dim);
+    W_k = reader.tensor(prefix + ".W_k", model_dim, model_dim);
+    W_v = reader.tensor(prefix + ".W_v", model_dim, model_dim);
+    if (num_heads > 1) {
+        W_o = reader.tensor(prefix + ".W_o", model_dim, model_dim);
+    }
+    W_q_int8 = W_k_int8 = W_v_int8 = W_o_int8 = QuantizedMatrix();
+}
+
+// Função que computa as pontuações de atenção escaladas entre Q e K
+Tensor SelfAttention::computeAttentionScores(ConstTensorView Q, ConstTensorView K) const {
+
+    // scores(i, j) = <Q_i, K_j> / sqrt(d), calculado para todos os pares com um único GEMM
+    Tensor scores(Q.rows(), K.rows());
+    VectorMath::gemm(Q, K, scores, true, real_t(1) / std::sqrt(static_cast<real_t>(Q.cols())));
+
+    // Retorna a matriz de scores
+    return scores;
+}
+
+// Função que projeta keys e values de uma sequência fixa (o output do encoder) para o cache
+void SelfAttention::projectKeysValues(ConstTensorView source, KVCache &cache) const {
+    cache.reserve(source.rows(), model_dim);
+    VectorMath::project(source, W_k, W_k_int8, cache.keys);
+    VectorMath::project(source, W_v, W_v_int8, cache.values);
+    cache.length = source.rows();
 }
 
 // Função que implementa a atenção cruzada (encoder-decoder attention)
-std::vector<double> SelfAttention::forward(const std::vector<double> &input, const std::vector<std::vector<double>> &encoder_input) const {
-    
-    // Esta implementação é um placeholder que retorna o input sem modificações
-    return input;
+Tensor SelfAttention::forward(const Tensor &input, const Tensor &encoder_input) const {
+
+    // Projeta keys e values do encoder e atende a eles
+    KVCache memory;
+    projectKeysValues(encoder_input, memory);
+    return forward(input, memory);
+}
+
+// Função que implementa a atenção cruzada em lote
+Tensor SelfAttention::forward(const Tensor &input, const BatchLayout &layout, const Tensor &encoder_input, const BatchLayout &encoder_layout) const {
+
+    Tensor output(input.rows(), model_dim);
+    forward(input, layout, encoder_input, encoder_layout, output, ActivationArena::local());
+    return output;
+}
+
+// Função que implementa a atenção cruzada em lote, escrevendo em output
+void SelfAttention::forward(ConstTensorView input, const BatchLayout &layout, ConstTensorView encoder_input,
+                            const BatchLayout &encoder_layout, TensorView output, ActivationArena &arena) const {
+    ActivationArena::Scope scope(arena);
+
+    // Queries do lote do decoder; keys e values do lote do encoder (padding incluído, mas nunca atendido)
+    TensorView Q = arena.allocate(input.rows(), model_dim);
+    TensorView K = arena.allocate(encoder_input.rows(), model_dim);
+    TensorView V = arena.allocate(encoder_input.rows(), model_dim);
+    VectorMath::project(input, W_q, W_q_int8, Q);
+    VectorMath::project(encoder_input, W_k, W_k_int8, K);
+    VectorMath::project(encoder_input, W_v, W_v_int8, V);
+    attend(Q, K, V, layout, encoder_layout, output, arena);
+}
+
+// Função que implementa a atenção cruzada com keys/values do encoder já projetados
+Tensor SelfAttention::forward(const Tensor &input, const KVCache &memory) const {
+
+    // As queries vêm do decoder; keys e values vêm do cache (a máscara causal não se aplica aqui)
+    Tensor Q = this->multiply(input, W_q, W_q_int8);
+    return attend(Q, memory.validKeys(), memory.validValues());
 }
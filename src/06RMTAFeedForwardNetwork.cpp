@@ -5,76 +5,115 @@
 // Inclui o arquivo de cabeçalho onde a classe FeedForwardNetwork é definida
 #include "../include/06RMTAFeedForwardNetwork.hpp"
 
+// Inclui a arena de onde vem a camada oculta temporária
+#include "../include/ActivationArena.hpp"
+
 // Construtor da classe FeedForwardNetwork
-FeedForwardNetwork::FeedForwardNetwork(int model_dim) 
-    : model_dim(model_dim) 
+FeedForwardNetwork::FeedForwardNetwork(int model_dim, ActivationFunction activation) 
+    : model_dim(model_dim), activation(activation),
+      w1_rows(activation == ActivationFunction::SwiGLU ? 2 * hidden_dim : hidden_dim)
 {
     // Inicializa os pesos e vieses para as duas camadas lineares
 
-    W1.resize(hidden_dim, std::vector<double>(model_dim));
-    b1.resize(hidden_dim);
+    W1.resize(w1_rows, model_dim);
+    b1.resize(w1_rows);
 
-    W2.resize(model_dim, std::vector<double>(hidden_dim));
+    W2.resize(model_dim, hidden_dim);
     b2.resize(model_dim);
 
-    initialize_weights(W1, hidden_dim, model_dim);
-    initialize_bias(b1, hidden_dim);
+    initialize_weights(W1, w1_rows, model_dim);
+    initialize_bias(b1, w1_rows);
 
     initialize_weights(W2, model_dim, hidden_dim);
     initialize_bias(b2, model_dim);
 }
 
 // Função para inicializar os pesos com valores aleatórios
-void FeedForwardNetwork::initialize_weights(std::vector<std::vector<double>>& weights, int rows, int cols) {
+void FeedForwardNetwork::initialize_weights(Tensor& weights, int rows, int cols) {
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_real_distribution<> dis(-0.1, 0.1);
 
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
-            weights[i][j] = dis(gen);
+            weights(i, j) = dis(gen);
         }
     }
 }
 
 // Função para inicializar os vieses
-void FeedForwardNetwork::initialize_bias(std::vector<double>& bias, int size) {
+void FeedForwardNetwork::initialize_bias(std::vector<real_t>& bias, int size) {
     std::fill(bias.begin(), bias.end(), 0.0); // Inicializa vieses como 0
 }
 
-// Função de ativação ReLU
-std::vector<double> FeedForwardNetwork::relu(const std::vector<double>& x) const {
-    std::vector<double> output(x.size());
-    for (size_t i = 0; i < x.size(); ++i) {
-        output[i] = std::max(0.0, x[i]);
-    }
-    return output;
+// Função que quantiza W1 e W2 em INT8 e libera as versões em ponto flutuante
+void FeedForwardNetwork::quantizeWeights() {
+    W1_int8 = QuantizedMatrix::quantize(W1);
+    W2_int8 = QuantizedMatrix::quantize(W2);
+    W1 = Tensor();
+    W2 = Tensor();
 }
 
-// Função que realiza o forward pass na rede feedforward
-std::vector<double> FeedForwardNetwork::forward(const std::vector<double> &input) const {
-    
-    // Passo 1: Aplicar a primeira transformação linear: xW1 + b1
-    std::vector<double> hidden_layer(hidden_dim, 0.0);
-    for (int i = 0; i < hidden_dim; ++i) {
-        for (int j = 0; j < model_dim; ++j) {
-            hidden_layer[i] += input[j] * W1[i][j];
-        }
-        hidden_layer[i] += b1[i];
+// Função que retorna a memória ocupada pelos pesos e vieses
+size_t FeedForwardNetwork::weightBytes() const {
+    return (W1.size() + W2.size() + b1.size() + b2.size()) * sizeof(real_t) + W1_int8.bytes() + W2_int8.bytes();
+}
+
+// Função que salva os pesos e vieses no checkpoint
+void FeedForwardNetwork::saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+    if (isQuantized()) {
+        throw std::logic_error("FeedForwardNetwork::saveParameters: pesos quantizados não podem ser salvos.");
     }
+    writer.addTensor(prefix + ".W1", W1);
+    writer.addVector(prefix + ".b1", b1);
+    writer.addTensor(prefix + ".W2", W2);
+    writer.addVector(prefix + ".b2", b2);
+}
+
+// Função que carrega os pesos e vieses do checkpoint (descartando uma eventual versão INT8)
+void FeedForwardNetwork::loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+    W1 = reader.tensor(prefix + ".W1", w1_rows, model_dim);
+    b1 = reader.vector(prefix + ".b1", w1_rows);
+    W2 = reader.tensor(prefix + ".W2", model_dim, hidden_dim);
+    b2 = reader.vector(prefix + ".b2", model_dim);
+    W1_int8 = W2_int8 = QuantizedMatrix();
+}
 
-    // Passo 2: Aplicar a função de ativação ReLU
-    hidden_layer = relu(hidden_layer);
+// Função que realiza o forward pass na rede feedforward
+Tensor FeedForwardNetwork::forward(const Tensor &input) const {
 
-    // Passo 3: Aplicar a segunda transformação linear: hidden_layer * W2 + b2
-    std::vector<double> output_layer(model_dim, 0.0);
-    for (int i = 0; i < model_dim; ++i) {
-        for (int j = 0; j < hidden_dim; ++j) {
-            output_layer[i] += hidden_layer[j] * W2[i][j];
-        }
-        output_layer[i] += b2[i];
-    }
+    // Aloca a saída, pega a camada oculta da arena da thread e delega para a versão com buffers
+    ActivationArena& scratch = ActivationArena::local();
+    ActivationArena::Scope scope(scratch);
+    Tensor output_layer(input.rows(), model_dim);
+    forward(input, scratch.allocate(input.rows(), getScratchDim()), output_layer);
 
     // Retorna o resultado da rede feedforward
     return output_layer;
 }
+
+// Função que realiza o forward pass escrevendo nos buffers fornecidos
+void FeedForwardNetwork::forward(ConstTensorView input, TensorView hidden_layer, TensorView output_layer, ConstTensorView residual) const {
+    const size_t rows = input.rows();
+
+    // Passo 1: primeira transformação linear para todas as posições de uma vez, X * W1^T, com bias e ativação
+    // aplicados no epílogo do GEMM. Com SwiGLU, o GEMM escreve os pares (gate, up) nas primeiras 2 * hidden_dim
+    // colunas de hidden_layer e o epílogo grava silu(gate) * up nas últimas hidden_dim.
+    GemmEpilogue<real_t> first;
+    first.bias = b1.data();
+    first.activation = activation;
+    TensorView activated = hidden_layer;
+    if (activation == ActivationFunction::SwiGLU) {
+        activated = hidden_layer.block(0, rows, w1_rows, hidden_dim);
+        first.gated = activated;
+        VectorMath::project(input, W1, W1_int8, hidden_layer.block(0, rows, 0, w1_rows), first);
+    } else {
+        VectorMath::project(input, W1, W1_int8, hidden_layer, first);
+    }
+
+    // Passo 2: segunda transformação linear, H * W2^T, com bias (e a soma residual, se pedida) no epílogo
+    GemmEpilogue<real_t> second;
+    second.bias = b2.data();
+    second.residual = residual;
+    VectorMath::project(activated, W2, W2_int8, output_layer, second);
+}
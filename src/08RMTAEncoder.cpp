@@ -5,21 +5,21 @@
 #include "../include/08RMTAEncoder.hpp"
 
 // Construtor da classe Encoder, inicializa o número de camadas e a dimensão do modelo
-Encoder::Encoder(int num_layers, int model_dim) : num_layers(num_layers), model_dim(model_dim) {
+Encoder::Encoder(int num_layers, int model_dim, int num_heads, ActivationFunction activation) : num_layers(num_layers), model_dim(model_dim) {
     
     // Adiciona 'num_layers' instâncias de EncoderLayer ao vetor 'layers'
     for (int i = 0; i < num_layers; ++i) {
         
         // Cria uma nova camada de EncoderLayer com a dimensão do modelo e adiciona à lista de camadas
-        layers.push_back(EncoderLayer(model_dim));
+        layers.push_back(EncoderLayer(model_dim, num_heads, activation));
     }
 }
 
 // Função que realiza o forward pass no encoder, processando os inputs através das camadas de Encoder
-std::vector<std::vector<double>> Encoder::forward(const std::vector<std::vector<double>>& inputs) {
+Tensor Encoder::forward(const Tensor& inputs) {
     
     // Inicializa os outputs como sendo os próprios inputs
-    auto outputs = inputs;
+    Tensor outputs = inputs;
     
     // Itera sobre cada camada do encoder e passa os outputs pela camada
     for (auto& layer : this->layers) {
@@ -31,3 +31,77 @@ std::vector<std::vector<double>> Encoder::forward(const std::vector<std::vector<
     // Retorna os outputs finais após passar por todas as camadas
     return outputs;
 }
+
+// Função que realiza o forward pass no encoder para um lote de sequências
+Tensor Encoder::forward(const Tensor& inputs, const BatchLayout& layout) {
+    Tensor outputs(inputs.rows(), inputs.cols());
+    forward(inputs, layout, outputs, ActivationArena::local());
+    return outputs;
+}
+
+// Função que realiza o forward pass no encoder para um lote, escrevendo em outputs
+void Encoder::forward(ConstTensorView inputs, const BatchLayout& layout, TensorView outputs, ActivationArena& arena) {
+    ActivationArena::Scope scope(arena);
+    if (layers.empty()) {
+        for (size_t i = 0; i < inputs.rows(); ++i) {
+            std::copy(inputs.row(i).begin(), inputs.row(i).end(), outputs.row(i).begin());
+        }
+        return;
+    }
+
+    // Cada camada lê a saída da anterior e escreve no outro buffer; a última escreve direto em outputs
+    TensorView buffers[2] = {arena.allocate(inputs.rows(), inputs.cols()), arena.allocate(inputs.rows(), inputs.cols())};
+    ConstTensorView current = inputs;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        TensorView next = i + 1 == layers.size() ? outputs : buffers[i % 2];
+        layers[i].forward(current, layout, next, arena);
+        current = next;
+    }
+}
+
+// Função que retorna o número de camadas do encoder
+size_t Encoder::numLayers() const {
+    return layers.size();
+}
+
+// Função que aplica apenas a camada 'index' a um lote de sequências
+Tensor Encoder::forwardLayer(size_t index, const Tensor& inputs, const BatchLayout& layout) {
+    return layers.at(index).forward(inputs, layout);
+}
+
+// Função que escolhe o kernel de atenção em todas as camadas do encoder
+void Encoder::setAttentionKernel(AttentionKernel kernel) {
+    for (auto& layer : this->layers) {
+        layer.setAttentionKernel(kernel);
+    }
+}
+
+// Função que quantiza em INT8 os pesos de todas as camadas do encoder
+void Encoder::quantizeWeights() {
+    for (auto& layer : layers) {
+        layer.quantizeWeights();
+    }
+}
+
+// Função que retorna a memória ocupada pelos pesos de todas as camadas do encoder
+size_t Encoder::weightBytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers) {
+        bytes += layer.weightBytes();
+    }
+    return bytes;
+}
+
+// Função que salva os parâmetros de todas as camadas do encoder no checkpoint
+void Encoder::saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].saveParameters(writer, prefix + ".layers." + std::to_string(i));
+    }
+}
+
+// Função que carrega os parâmetros de todas as camadas do encoder do checkpoint
+void Encoder::loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].loadParameters(reader, prefix + ".layers." + std::to_string(i));
+    }
+}
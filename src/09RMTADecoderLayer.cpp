@@ -5,62 +5,96 @@
 #include "../include/09RMTADecoderLayer.hpp"
 
 // Função que realiza o forward pass na camada do decoder, processando as entradas do decoder e os outputs do encoder
-std::vector<std::vector<double>> DecoderLayer::forward(const std::vector<std::vector<double>>& decoderInput, const std::vector<std::vector<double>>& encoderOutput) {
+Tensor DecoderLayer::forward(const Tensor& decoderInput, const Tensor& encoderOutput) {
 
-    // Aplicação da self-attention no input do decoder
-    std::vector<std::vector<double>> selfAttnOutput(decoderInput.size(), std::vector<double>(decoderInput[0].size()));
-    
-    for (size_t i = 0; i < decoderInput.size(); ++i) {
-        
-        // Self-attention é aplicada em cada token da sequência
-        selfAttnOutput[i] = selfAttention.forward(decoderInput[i]);
-    }
-
-    // Soma residual entre a entrada do decoder e a saída da self-attention, seguida de normalização
-    std::vector<std::vector<double>> addNorm1(decoderInput.size(), std::vector<double>(decoderInput[0].size()));
-    
-    for (size_t i = 0; i < decoderInput.size(); ++i) {
-        
-        // Soma da entrada original com a saída da self-attention e normalização (LayerNorm1)
-        addNorm1[i] = layerNorm1.normalize(add(decoderInput[i], selfAttnOutput[i]));
-    }
+    // Uma sequência só é um lote de tamanho 1
+    return forward(decoderInput, BatchLayout::single(decoderInput.rows()), encoderOutput, BatchLayout::single(encoderOutput.rows()));
+}
+
+// Função que realiza o forward pass na camada do decoder para um lote de sequências
+Tensor DecoderLayer::forward(const Tensor& decoderInput, const BatchLayout& layout, const Tensor& encoderOutput, const BatchLayout& encoderLayout) {
+    Tensor output(decoderInput.rows(), decoderInput.cols());
+    forward(decoderInput, layout, encoderOutput, encoderLayout, output, ActivationArena::local());
+    return output;
+}
+
+// Função que realiza o forward pass na camada do decoder para um lote, escrevendo em output
+void DecoderLayer::forward(ConstTensorView decoderInput, const BatchLayout& layout, ConstTensorView encoderOutput,
+                           const BatchLayout& encoderLayout, TensorView output, ActivationArena& arena) {
+
+    // As ativações intermediárias ficam na arena e são devolvidas a ela no fim da camada
+    ActivationArena::Scope scope(arena);
+
+    // Número de posições (de todas as sequências, padding incluído) e dimensão de cada posição
+    const size_t seq_len = decoderInput.rows();
+    const size_t dim = decoderInput.cols();
+
+    // Aplicação da self-attention no input do decoder, uma única vez para o lote inteiro
+    TensorView selfAttnOutput = arena.allocate(seq_len, dim);
+    selfAttention.forward(decoderInput, layout, selfAttnOutput, arena);
+
+    // Soma residual entre a entrada do decoder e a saída da self-attention, seguida de normalização (LayerNorm1), em
+    // um único kernel fundido
+    TensorView addNorm1 = arena.allocate(seq_len, dim);
+    layerNorm1.addNormalize(decoderInput, selfAttnOutput, addNorm1);
 
     // Aplicação da encoder-decoder attention (cross-attention)
-    std::vector<std::vector<double>> encDecAttnOutput(addNorm1.size(), std::vector<double>(addNorm1[0].size()));
-    
-    for (size_t i = 0; i < addNorm1.size(); ++i) {
-        
-        // Cross-attention entre a saída da normalização e o output do encoder
-        encDecAttnOutput[i] = encDecAttention.forward(addNorm1[i], encoderOutput);  
-    }
+    // Cross-attention entre a saída da normalização e o output do encoder (keys/values projetadas uma vez para o lote inteiro)
+    TensorView encDecAttnOutput = arena.allocate(seq_len, dim);
+    encDecAttention.forward(addNorm1, layout, encoderOutput, encoderLayout, encDecAttnOutput, arena);
 
     // Soma residual entre a saída da cross-attention e a saída da normalização anterior, seguida de normalização (LayerNorm2)
-    std::vector<std::vector<double>> addNorm2(addNorm1.size(), std::vector<double>(addNorm1[0].size()));
-    
-    for (size_t i = 0; i < addNorm1.size(); ++i) {
-        addNorm2[i] = layerNorm2.normalize(add(addNorm1[i], encDecAttnOutput[i]));
-    }
+    TensorView addNorm2 = arena.allocate(seq_len, dim);
+    layerNorm2.addNormalize(addNorm1, encDecAttnOutput, addNorm2);
 
     // Aplicação da rede feedforward para processamento adicional
-    std::vector<std::vector<double>> ffOutput(addNorm2.size(), std::vector<double>(addNorm2[0].size()));
-    
-    for (size_t i = 0; i < addNorm2.size(); ++i) {
-        ffOutput[i] = feedForward.forward(addNorm2[i]);
-    }
+    TensorView hidden = arena.allocate(seq_len, feedForward.getScratchDim());
+    TensorView ffOutput = arena.allocate(seq_len, dim);
+    feedForward.forward(addNorm2, hidden, ffOutput);
 
-    // Soma residual entre a saída da feedforward network e a saída da normalização anterior, seguida de normalização (LayerNorm3)
-    std::vector<std::vector<double>> addNorm3(addNorm2.size(), std::vector<double>(addNorm2[0].size()));
-    
-    for (size_t i = 0; i < addNorm2.size(); ++i) {
-        addNorm3[i] = layerNorm3.normalize(add(addNorm2[i], ffOutput[i]));
-    }
+    // Soma residual entre a saída da feedforward network e a saída da normalização anterior, seguida de normalização
+    // (LayerNorm3), escrita direto na saída da camada
+    layerNorm3.addNormalize(addNorm2, ffOutput, output);
+}
+
+// Função que prepara o estado de decodificação incremental da camada
+void DecoderLayer::initState(DecoderLayerState& state, size_t max_seq_len, const Tensor& encoderOutput) const {
+    state.selfCache.reserve(max_seq_len, model_dim);
+    state.scratch.reserve(max_seq_len, model_dim);
+    encDecAttention.projectKeysValues(encoderOutput, state.crossCache);
+    state.crossScratch.reserve(encoderOutput.rows(), model_dim);
+    state.selfAttnOutput.resize(1, model_dim);
+    state.addNorm1.resize(1, model_dim);
+    state.encDecAttnOutput.resize(1, model_dim);
+    state.addNorm2.resize(1, model_dim);
+    state.hidden.resize(1, feedForward.getScratchDim());
+    state.ffOutput.resize(1, model_dim);
+}
+
+// Função que processa uma única nova posição, com as mesmas etapas do forward
+void DecoderLayer::step(DecoderLayerState& state, ConstTensorView input, TensorView output) const {
+
+    // Self-attention causal da nova posição contra as posições já armazenadas no cache
+    selfAttention.step(input, state.selfCache, state.scratch, state.selfAttnOutput);
+
+    // Soma residual e normalização (LayerNorm1)
+    layerNorm1.addNormalize(input, state.selfAttnOutput, state.addNorm1);
+
+    // Cross-attention contra as keys/values do encoder já projetadas em initState
+    encDecAttention.crossStep(state.addNorm1, state.crossCache, state.crossScratch, state.encDecAttnOutput);
+
+    // Soma residual e normalização (LayerNorm2)
+    layerNorm2.addNormalize(state.addNorm1, state.encDecAttnOutput, state.addNorm2);
+
+    // Rede feedforward escrevendo nos buffers do estado
+    feedForward.forward(state.addNorm2, state.hidden, state.ffOutput);
 
-    // Retorna o resultado final da camada após o processamento completo
-    return addNorm3;
+    // Soma residual e normalização (LayerNorm3) direto na saída
+    layerNorm3.addNormalize(state.addNorm2, state.ffOutput, output);
 }
 
 // Função que realiza o backward pass na camada do decoder (neste momento, é apenas um placeholder)
-std::vector<std::vector<double>> DecoderLayer::backward(const std::vector<std::vector<double>>& dL_dOutputs, const std::vector<std::vector<double>>& encoderOutputs) {
+Tensor DecoderLayer::backward(const Tensor& dL_dOutputs, const Tensor& encoderOutputs) {
     
     // Não implementado. Apenas retorna o que recebeu como entrada
     return dL_dOutputs;
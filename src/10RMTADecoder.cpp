@@ -5,19 +5,19 @@
 #include "../include/10RMTADecoder.hpp"
 
 // Construtor da classe Decoder, inicializa o número de camadas e a dimensão do modelo
-Decoder::Decoder(int num_layers, int model_dim) : num_layers(num_layers), model_dim(model_dim) {
+Decoder::Decoder(int num_layers, int model_dim, int num_heads, ActivationFunction activation) : num_layers(num_layers), model_dim(model_dim) {
     
     // Cria 'num_layers' instâncias de DecoderLayer e adiciona ao vetor 'layers'
     for (int i = 0; i < num_layers; ++i) {
-        layers.push_back(DecoderLayer(model_dim));
+        layers.push_back(DecoderLayer(model_dim, num_heads, activation));
     }
 }
 
 // Função que realiza o forward pass no decoder
-std::vector<std::vector<double>> *Decoder::forward(const std::vector<std::vector<double>>& input, const std::vector<std::vector<double>>& encoderOutput) {
+Tensor *Decoder::forward(const Tensor& input, const Tensor& encoderOutput) {
     
     // Inicializa os outputs como uma cópia dos inputs
-    std::vector<std::vector<double>> *outputs = new std::vector<std::vector<double>>(input);
+    Tensor *outputs = new Tensor(input);
     
     // Itera sobre as camadas do decoder e aplica o forward de cada uma
     for (auto& layer : layers) {
@@ -30,11 +30,82 @@ std::vector<std::vector<double>> *Decoder::forward(const std::vector<std::vector
     return outputs;
 }
 
+// Função que realiza o forward pass no decoder para um lote de sequências
+Tensor *Decoder::forward(const Tensor& input, const BatchLayout& layout, const Tensor& encoderOutput, const BatchLayout& encoderLayout) {
+    Tensor *outputs = new Tensor(input.rows(), input.cols());
+    forward(input, layout, encoderOutput, encoderLayout, *outputs, ActivationArena::local());
+    return outputs;
+}
+
+// Função que realiza o forward pass no decoder para um lote, escrevendo em output
+void Decoder::forward(ConstTensorView input, const BatchLayout& layout, ConstTensorView encoderOutput, const BatchLayout& encoderLayout,
+                      TensorView output, ActivationArena& arena) {
+    ActivationArena::Scope scope(arena);
+    if (layers.empty()) {
+        for (size_t i = 0; i < input.rows(); ++i) {
+            std::copy(input.row(i).begin(), input.row(i).end(), output.row(i).begin());
+        }
+        return;
+    }
+
+    // Cada camada lê a saída da anterior e escreve no outro buffer; a última escreve direto em output
+    TensorView buffers[2] = {arena.allocate(input.rows(), input.cols()), arena.allocate(input.rows(), input.cols())};
+    ConstTensorView current = input;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        TensorView next = i + 1 == layers.size() ? output : buffers[i % 2];
+        layers[i].forward(current, layout, encoderOutput, encoderLayout, next, arena);
+        current = next;
+    }
+}
+
+// Função que retorna o número de camadas do decoder
+size_t Decoder::numLayers() const {
+    return layers.size();
+}
+
+// Função que aplica apenas a camada 'index' a um lote de sequências
+Tensor Decoder::forwardLayer(size_t index, const Tensor& input, const BatchLayout& layout, const Tensor& encoderOutput, const BatchLayout& encoderLayout) {
+    return layers.at(index).forward(input, layout, encoderOutput, encoderLayout);
+}
+
+// Função que inicia uma sessão de decodificação incremental, reservando toda a memória dos passos
+DecoderSession Decoder::startSession(const Tensor& encoderOutput, size_t max_seq_len) const {
+    DecoderSession session;
+    session.layers.resize(layers.size());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].initState(session.layers[i], max_seq_len, encoderOutput);
+    }
+    session.current.resize(1, model_dim);
+    session.next.resize(1, model_dim);
+    session.max_seq_len = max_seq_len;
+    return session;
+}
+
+// Função que processa a próxima posição da sessão
+std::span<const real_t> Decoder::step(DecoderSession& session, std::span<const real_t> input) const {
+    if (input.size() != static_cast<size_t>(model_dim)) {
+        throw std::invalid_argument("Decoder::step: o input deve ter model_dim valores.");
+    }
+    if (session.length >= session.max_seq_len) {
+        throw std::length_error("Decoder::step: sessão cheia (aumente max_seq_len).");
+    }
+
+    // Copia a entrada para o buffer da sessão e passa pelas camadas alternando os dois buffers
+    std::copy(input.begin(), input.end(), session.current.row(0).begin());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].step(session.layers[i], session.current, session.next);
+        std::swap(session.current, session.next);
+    }
+
+    ++session.length;
+    return session.current.row(0);
+}
+
 // Função que realiza o backward pass no decoder, propagando os gradientes
-void Decoder::backward(const std::vector<std::vector<double>>& dL_dDecoderOutputs, const std::vector<std::vector<double>>& encoderOutputs) {
+void Decoder::backward(const Tensor& dL_dDecoderOutputs, const Tensor& encoderOutputs) {
     
     // Inicializa os gradientes da entrada como os gradientes da saída do decoder
-    std::vector<std::vector<double>> dL_dInputs = dL_dDecoderOutputs;
+    Tensor dL_dInputs = dL_dDecoderOutputs;
 
     // Itera sobre as camadas do decoder em ordem reversa (para o backward pass)
     for (auto it = layers.rbegin(); it != layers.rend(); ++it) {
@@ -43,3 +114,40 @@ void Decoder::backward(const std::vector<std::vector<double>>& dL_dDecoderOutput
         dL_dInputs = it->backward(dL_dInputs, encoderOutputs);
     }
 }
+
+// Função que escolhe o kernel de atenção em todas as camadas do decoder
+void Decoder::setAttentionKernel(AttentionKernel kernel) {
+    for (auto& layer : layers) {
+        layer.setAttentionKernel(kernel);
+    }
+}
+
+// Função que quantiza em INT8 os pesos de todas as camadas do decoder
+void Decoder::quantizeWeights() {
+    for (auto& layer : layers) {
+        layer.quantizeWeights();
+    }
+}
+
+// Função que retorna a memória ocupada pelos pesos de todas as camadas do decoder
+size_t Decoder::weightBytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers) {
+        bytes += layer.weightBytes();
+    }
+    return bytes;
+}
+
+// Função que salva os parâmetros de todas as camadas do decoder no checkpoint
+void Decoder::saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].saveParameters(writer, prefix + ".layers." + std::to_string(i));
+    }
+}
+
+// Função que carrega os parâmetros de todas as camadas do decoder do checkpoint
+void Decoder::loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+    for (size_t i = 0; i < layers.size(); ++i) {
+        layers[i].loadParameters(reader, prefix + ".layers." + std::to_string(i));
+    }
+}
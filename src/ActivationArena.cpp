@@ -0,0 +1,96 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe ActivationArena é definida
+#include "../include/ActivationArena.hpp"
+
+// Inclui std::max
+#include <algorithm>
+
+// Cada pedido ocupa um múltiplo do alinhamento, para a próxima matriz também começar alinhada
+static constexpr std::size_t ARENA_ALIGNMENT_VALUES = TENSOR_ALIGNMENT / sizeof(real_t);
+
+// Construtor que reserva a capacidade inicial
+ActivationArena::ActivationArena(std::size_t initial_capacity) {
+    if (initial_capacity > 0) {
+        blocks.emplace_back(initial_capacity);
+        ++heap_allocations;
+    }
+}
+
+// Função que entrega uma matriz rows x cols a partir da posição atual
+TensorView ActivationArena::allocate(std::size_t rows, std::size_t cols) {
+    const std::size_t values = (rows * cols + ARENA_ALIGNMENT_VALUES - 1) / ARENA_ALIGNMENT_VALUES * ARENA_ALIGNMENT_VALUES;
+    if (current >= blocks.size() || offset + values > blocks[current].size()) {
+        advanceBlock(values);
+    }
+    real_t* data = blocks[current].data() + offset;
+    offset += values;
+    peak_used = std::max(peak_used, used_before + offset);
+    return TensorView(data, rows, cols);
+}
+
+// Função que passa para o bloco seguinte, reaproveitando-o se couber o pedido
+void ActivationArena::advanceBlock(std::size_t values) {
+
+    // O resto do bloco atual fica sem uso até a próxima devolução
+    if (current < blocks.size()) {
+        used_before += blocks[current].size();
+        ++current;
+    }
+
+    // Os blocos depois do atual estão livres; os pequenos demais para o pedido são descartados
+    while (current < blocks.size() && blocks[current].size() < values) {
+        blocks.erase(blocks.begin() + current);
+    }
+
+    // Sem bloco livre, cria um novo com pelo menos o tamanho de todos os anteriores (crescimento geométrico)
+    if (current == blocks.size()) {
+        blocks.emplace_back(std::max(values, capacity()));
+        ++heap_allocations;
+    }
+    offset = 0;
+}
+
+// Função que retorna a posição atual
+ActivationArena::Mark ActivationArena::mark() const {
+    return Mark{current, offset};
+}
+
+// Função que devolve tudo o que foi pedido depois de 'mark'
+void ActivationArena::release(Mark mark) {
+    current = mark.block;
+    offset = mark.offset;
+    used_before = 0;
+    for (std::size_t b = 0; b < current && b < blocks.size(); ++b) {
+        used_before += blocks[b].size();
+    }
+}
+
+// Função que devolve tudo e junta os blocos em um único bloco contíguo
+void ActivationArena::reset() {
+    if (blocks.size() > 1) {
+        const std::size_t total = capacity();
+        blocks.clear();
+        blocks.emplace_back(total);
+        ++heap_allocations;
+    }
+    current = 0;
+    offset = 0;
+    used_before = 0;
+}
+
+// Função que retorna o número de valores reservados em todos os blocos
+std::size_t ActivationArena::capacity() const {
+    std::size_t total = 0;
+    for (const auto& block : blocks) {
+        total += block.size();
+    }
+    return total;
+}
+
+// Arena da thread atual
+ActivationArena& ActivationArena::local() {
+    thread_local ActivationArena arena;
+    return arena;
+}
@@ -0,0 +1,393 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe BPETokenizer é definida
+#include "../include/BPETokenizer.hpp"
+
+// Inclui std::priority_queue
+#include <queue>
+
+// Inclui std::sort
+#include <algorithm>
+
+// Inclui std::isspace
+#include <cctype>
+
+// Inclui std::memcpy
+#include <cstring>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Indica se um byte é espaço em branco
+static bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+// Função que percorre o texto em pedaços "espaços + palavra", chamando visit(espaços, palavra) para cada um
+template <typename Visitor>
+static void forEachChunk(std::string_view text, Visitor&& visit) {
+    std::size_t position = 0;
+    while (position < text.size()) {
+        std::size_t word_begin = position;
+        while (word_begin < text.size() && isSpace(text[word_begin])) {
+            ++word_begin;
+        }
+        std::size_t word_end = word_begin;
+        while (word_end < text.size() && !isSpace(text[word_end])) {
+            ++word_end;
+        }
+        visit(text.substr(position, word_begin - position), text.substr(word_begin, word_end - word_begin));
+        position = word_end;
+    }
+}
+
+// Função que treina o vocabulário BPE
+BPETokenizer BPETokenizer::train(const std::vector<std::string>& corpus, int vocab_size,
+                                 const std::vector<std::string>& special_tokens, int min_frequency) {
+    BPETokenizer tokenizer;
+    tokenizer.special_tokens = special_tokens;
+    tokenizer.rebuildTables();
+
+    // Conta a frequência de cada pedaço distinto (os tokens especiais não participam das fusões)
+    std::unordered_map<std::string, int64_t> chunk_counts;
+    for (const std::string& line : corpus) {
+        forEachChunk(line, [&](std::string_view spaces, std::string_view word) {
+            if (!word.empty() && tokenizer.specialTokenId(word) >= 0) {
+                if (!spaces.empty()) {
+                    ++chunk_counts[std::string(spaces)];
+                }
+            } else {
+                ++chunk_counts[std::string(spaces) + std::string(word)];
+            }
+        });
+    }
+
+    // Ordena os pedaços para que o resultado não dependa da ordem de iteração do hash map
+    std::vector<std::pair<std::string, int64_t>> sorted_chunks(chunk_counts.begin(), chunk_counts.end());
+    std::sort(sorted_chunks.begin(), sorted_chunks.end());
+
+    // Cada pedaço distinto vira uma "palavra" com seus símbolos atuais (inicialmente, os bytes) e sua frequência
+    struct Word {
+        std::vector<int> symbols;
+        int64_t count;
+    };
+    std::vector<Word> words;
+    words.reserve(sorted_chunks.size());
+    for (const auto& [chunk, count] : sorted_chunks) {
+        Word word{std::vector<int>(chunk.size()), count};
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            word.symbols[i] = static_cast<unsigned char>(chunk[i]);
+        }
+        words.push_back(std::move(word));
+    }
+
+    // Contagem de cada par adjacente e lista das palavras onde ele aparece.
+    // As contagens são atualizadas incrementalmente: uma fusão só revisita as palavras que contêm o par fundido.
+    std::unordered_map<uint64_t, int64_t> pair_counts;
+    std::unordered_map<uint64_t, std::vector<int>> pair_words;
+    auto addPairs = [&](int w, int64_t sign, std::vector<uint64_t>* changed) {
+        const std::vector<int>& symbols = words[w].symbols;
+        for (std::size_t i = 0; i + 1 < symbols.size(); ++i) {
+            uint64_t key = pairKey(symbols[i], symbols[i + 1]);
+            pair_counts[key] += sign * words[w].count;
+            if (sign > 0) {
+                std::vector<int>& where = pair_words[key];
+                if (where.empty() || where.back() != w) {
+                    where.push_back(w);
+                }
+            }
+            if (changed) {
+                changed->push_back(key);
+            }
+        }
+    };
+    for (int w = 0; w < static_cast<int>(words.size()); ++w) {
+        addPairs(w, +1, nullptr);
+    }
+
+    // Heap de máximo (contagem, par) com entradas preguiçosas: uma entrada cuja contagem não bate com a atual é descartada.
+    // Empates são decididos pelo menor par, para que o treino seja determinístico.
+    using Candidate = std::pair<int64_t, uint64_t>;
+    auto lower = [](const Candidate& a, const Candidate& b) {
+        return a.first < b.first || (a.first == b.first && a.second > b.second);
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(lower)> heap(lower);
+    for (const auto& [key, count] : pair_counts) {
+        heap.push({count, key});
+    }
+
+    // Marca as palavras já processadas na fusão atual (pair_words pode listar a mesma palavra mais de uma vez)
+    std::vector<int> visited(words.size(), -1);
+    std::vector<uint64_t> changed;
+
+    while (tokenizer.getVocabSize() < vocab_size && !heap.empty()) {
+        auto [count, key] = heap.top();
+        heap.pop();
+        auto current = pair_counts.find(key);
+        if (current == pair_counts.end() || current->second != count) {
+            continue;
+        }
+        if (count < min_frequency) {
+            break;
+        }
+
+        // Registra a nova fusão
+        int left = static_cast<int>(key >> 32), right = static_cast<int>(key & 0xffffffffu);
+        int merged = tokenizer.firstMergeId() + static_cast<int>(tokenizer.merges.size());
+        tokenizer.merges.push_back({left, right});
+        tokenizer.token_bytes.push_back(tokenizer.token_bytes[left] + tokenizer.token_bytes[right]);
+
+        // Reescreve apenas as palavras que contêm o par, atualizando as contagens dos pares vizinhos
+        std::vector<int> affected = std::move(pair_words[key]);
+        pair_words.erase(key);
+        changed.clear();
+        int iteration = static_cast<int>(tokenizer.merges.size());
+        for (int w : affected) {
+            if (visited[w] == iteration) {
+                continue;
+            }
+            visited[w] = iteration;
+
+            addPairs(w, -1, &changed);
+            std::vector<int>& symbols = words[w].symbols;
+            std::size_t out = 0;
+            for (std::size_t i = 0; i < symbols.size(); ++i) {
+                if (i + 1 < symbols.size() && symbols[i] == left && symbols[i + 1] == right) {
+                    symbols[out++] = merged;
+                    ++i;
+                } else {
+                    symbols[out++] = symbols[i];
+                }
+            }
+            symbols.resize(out);
+            addPairs(w, +1, &changed);
+        }
+
+        // O par fundido não existe mais; os pares alterados voltam ao heap com a contagem nova
+        pair_counts.erase(key);
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+        for (uint64_t changed_key : changed) {
+            auto it = pair_counts.find(changed_key);
+            if (it == pair_counts.end()) {
+                continue;
+            }
+            if (it->second <= 0) {
+                pair_counts.erase(it);
+            } else if (changed_key != key) {
+                heap.push({it->second, changed_key});
+            }
+        }
+    }
+
+    tokenizer.rebuildTables();
+    return tokenizer;
+}
+
+// Função que reconstrói a tabela de ranks e os bytes de cada token
+void BPETokenizer::rebuildTables() {
+    token_bytes.clear();
+    token_bytes.reserve(BPE_BYTE_TOKENS + special_tokens.size() + merges.size());
+    for (int byte = 0; byte < BPE_BYTE_TOKENS; ++byte) {
+        token_bytes.push_back(std::string(1, static_cast<char>(byte)));
+    }
+    for (const std::string& special : special_tokens) {
+        token_bytes.push_back(special);
+    }
+    merge_ranks.clear();
+    merge_ranks.reserve(merges.size());
+    for (std::size_t rank = 0; rank < merges.size(); ++rank) {
+        auto [left, right] = merges[rank];
+        merge_ranks[pairKey(left, right)] = static_cast<int>(rank);
+        token_bytes.push_back(token_bytes[left] + token_bytes[right]);
+    }
+}
+
+// Função que retorna o ID de um token especial
+int BPETokenizer::specialTokenId(std::string_view token) const {
+    for (std::size_t i = 0; i < special_tokens.size(); ++i) {
+        if (special_tokens[i] == token) {
+            return BPE_BYTE_TOKENS + static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+// Função que converte um texto em IDs de tokens
+std::vector<int> BPETokenizer::tokenize(std::string_view text) const {
+    std::vector<int> tokens;
+    tokens.reserve(text.size() / 2 + 1);
+    forEachChunk(text, [&](std::string_view spaces, std::string_view word) {
+        int special = word.empty() ? -1 : specialTokenId(word);
+        if (special >= 0) {
+            encodeChunk(spaces, tokens);
+            tokens.push_back(special);
+        } else {
+            encodeChunk(std::string_view(spaces.data(), spaces.size() + word.size()), tokens);
+        }
+    });
+    return tokens;
+}
+
+// Função que aplica as fusões a um pedaço de texto.
+// Os símbolos formam uma lista duplamente encadeada e os pares com rank ficam em um heap de mínimo (rank, posição):
+// cada fusão custa O(log n), em vez de reescanear o pedaço inteiro procurando o par de menor rank.
+void BPETokenizer::encodeChunk(std::string_view chunk, std::vector<int>& output) const {
+    const int n = static_cast<int>(chunk.size());
+    if (n == 0) {
+        return;
+    }
+    if (n == 1) {
+        output.push_back(static_cast<unsigned char>(chunk[0]));
+        return;
+    }
+
+    // Símbolo atual de cada posição (-1 quando a posição foi absorvida pela fusão com a vizinha da esquerda)
+    std::vector<int> symbols(n), prev(n), next(n);
+    for (int i = 0; i < n; ++i) {
+        symbols[i] = static_cast<unsigned char>(chunk[i]);
+        prev[i] = i - 1;
+        next[i] = i + 1;
+    }
+
+    // Rank do par que começa na posição 'left', ou -1 se o par não tiver regra de fusão
+    auto rankAt = [&](int left) {
+        if (left < 0 || next[left] >= n) {
+            return -1;
+        }
+        auto it = merge_ranks.find(pairKey(symbols[left], symbols[next[left]]));
+        return it == merge_ranks.end() ? -1 : it->second;
+    };
+
+    using Candidate = std::pair<int, int>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> heap;
+    for (int i = 0; i + 1 < n; ++i) {
+        int rank = rankAt(i);
+        if (rank >= 0) {
+            heap.push({rank, i});
+        }
+    }
+
+    // Aplica sempre a fusão de menor rank (e, no empate, a mais à esquerda)
+    const int first_merge = firstMergeId();
+    while (!heap.empty()) {
+        auto [rank, left] = heap.top();
+        heap.pop();
+
+        // Descarta entradas obsoletas: a posição foi absorvida ou o par mudou desde que a entrada foi criada
+        if (symbols[left] < 0 || rankAt(left) != rank) {
+            continue;
+        }
+
+        // Funde o par: a posição da esquerda recebe o novo token e a da direita sai da lista
+        int right = next[left];
+        symbols[left] = first_merge + rank;
+        symbols[right] = -1;
+        next[left] = next[right];
+        if (next[right] < n) {
+            prev[next[right]] = left;
+        }
+
+        // Os pares com os novos vizinhos podem ter regra de fusão
+        for (int candidate : {prev[left], left}) {
+            int candidate_rank = rankAt(candidate);
+            if (candidate_rank >= 0) {
+                heap.push({candidate_rank, candidate});
+            }
+        }
+    }
+
+    for (int i = 0; i < n; i = next[i]) {
+        output.push_back(symbols[i]);
+    }
+}
+
+// Função que converte IDs de tokens de volta para o texto
+std::string BPETokenizer::detokenize(std::span<const int> tokens) const {
+    std::string text;
+    for (int token : tokens) {
+        text += token_bytes.at(token);
+    }
+    return text;
+}
+
+// Acrescenta um uint32 ao final de um buffer de bytes
+static void appendUint32(std::vector<char>& bytes, uint32_t value) {
+    const char* raw = reinterpret_cast<const char*>(&value);
+    bytes.insert(bytes.end(), raw, raw + sizeof(value));
+}
+
+// Função que serializa o vocabulário
+std::vector<char> BPETokenizer::serialize() const {
+    std::vector<char> bytes;
+    appendUint32(bytes, static_cast<uint32_t>(special_tokens.size()));
+    uint32_t offset = 0;
+    appendUint32(bytes, offset);
+    for (const std::string& special : special_tokens) {
+        offset += static_cast<uint32_t>(special.size());
+        appendUint32(bytes, offset);
+    }
+    for (const std::string& special : special_tokens) {
+        bytes.insert(bytes.end(), special.begin(), special.end());
+    }
+    appendUint32(bytes, static_cast<uint32_t>(merges.size()));
+    for (auto [left, right] : merges) {
+        appendUint32(bytes, static_cast<uint32_t>(left));
+        appendUint32(bytes, static_cast<uint32_t>(right));
+    }
+    return bytes;
+}
+
+// Função que reconstrói um vocabulário serializado
+BPETokenizer BPETokenizer::deserialize(std::span<const char> bytes) {
+    std::size_t position = 0;
+    auto readUint32 = [&]() {
+        uint32_t value;
+        if (position + sizeof(value) > bytes.size()) {
+            throw std::runtime_error("BPETokenizer::deserialize: dados truncados");
+        }
+        std::memcpy(&value, bytes.data() + position, sizeof(value));
+        position += sizeof(value);
+        return value;
+    };
+
+    BPETokenizer tokenizer;
+
+    // Tokens especiais: tabela de deslocamentos seguida dos caracteres
+    uint32_t special_count = readUint32();
+    if ((std::size_t(special_count) + 1) * sizeof(uint32_t) > bytes.size() - position) {
+        throw std::runtime_error("BPETokenizer::deserialize: dados truncados");
+    }
+    std::vector<uint32_t> offsets(std::size_t(special_count) + 1);
+    for (uint32_t& offset : offsets) {
+        offset = readUint32();
+    }
+    if (offsets.back() > bytes.size() - position) {
+        throw std::runtime_error("BPETokenizer::deserialize: dados truncados");
+    }
+    for (uint32_t i = 0; i < special_count; ++i) {
+        if (offsets[i] > offsets[i + 1]) {
+            throw std::runtime_error("BPETokenizer::deserialize: deslocamentos inválidos");
+        }
+    }
+    for (uint32_t i = 0; i < special_count; ++i) {
+        tokenizer.special_tokens.emplace_back(bytes.data() + position + offsets[i], offsets[i + 1] - offsets[i]);
+    }
+    position += offsets.back();
+
+    // Fusões: cada uma só pode referenciar tokens definidos antes dela
+    uint32_t merge_count = readUint32();
+    int next_id = tokenizer.firstMergeId();
+    for (uint32_t i = 0; i < merge_count; ++i, ++next_id) {
+        int left = static_cast<int>(readUint32());
+        int right = static_cast<int>(readUint32());
+        if (left < 0 || right < 0 || left >= next_id || right >= next_id) {
+            throw std::runtime_error("BPETokenizer::deserialize: fusão inválida");
+        }
+        tokenizer.merges.push_back({left, right});
+    }
+
+    tokenizer.rebuildTables();
+    return tokenizer;
+}
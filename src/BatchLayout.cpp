@@ -0,0 +1,71 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a estrutura BatchLayout é definida
+#include "../include/BatchLayout.hpp"
+
+// Inclui std::max_element, std::sort e std::copy
+#include <algorithm>
+
+// Inclui std::iota
+#include <numeric>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Função que monta um lote com um exemplo por sequência
+BatchLayout BatchLayout::fromLengths(const std::vector<size_t>& lengths) {
+    BatchLayout layout;
+    layout.max_len = lengths.empty() ? 0 : *std::max_element(lengths.begin(), lengths.end());
+    layout.batch_size = lengths.size();
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        layout.segments.push_back(Segment{i * layout.max_len, lengths[i]});
+    }
+    return layout;
+}
+
+// Função que empacota os exemplos em sequências de seq_len posições
+BatchLayout BatchLayout::pack(const std::vector<size_t>& lengths, size_t seq_len) {
+    BatchLayout layout;
+    layout.max_len = std::max(seq_len, lengths.empty() ? size_t(0) : *std::max_element(lengths.begin(), lengths.end()));
+    layout.segments.resize(lengths.size());
+
+    // Exemplos do maior para o menor (empates na ordem original, para o resultado não depender da ordenação)
+    std::vector<size_t> order(lengths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return lengths[a] > lengths[b]; });
+
+    // Cada exemplo vai para a primeira sequência com espaço livre suficiente, ou abre uma nova
+    std::vector<size_t> used;
+    for (size_t i : order) {
+        size_t b = 0;
+        while (b < used.size() && used[b] + lengths[i] > layout.max_len) {
+            ++b;
+        }
+        if (b == used.size()) {
+            used.push_back(0);
+        }
+        layout.segments[i] = Segment{b * layout.max_len + used[b], lengths[i]};
+        used[b] += lengths[i];
+    }
+    layout.batch_size = used.size();
+    return layout;
+}
+
+// Função que monta a matriz do lote
+Tensor BatchLayout::pad(const std::vector<ConstTensorView>& sequences) const {
+    if (sequences.size() != segments.size()) {
+        throw std::invalid_argument("BatchLayout::pad: número de exemplos diferente do lote.");
+    }
+    const size_t cols = sequences.empty() ? 0 : sequences[0].cols();
+    Tensor batch(rows(), cols);
+    for (size_t i = 0; i < sequences.size(); ++i) {
+        if (sequences[i].rows() != length(i) || sequences[i].cols() != cols) {
+            throw std::invalid_argument("BatchLayout::pad: exemplo com dimensões diferentes das do lote.");
+        }
+        for (size_t t = 0; t < length(i); ++t) {
+            std::copy(sequences[i].row(t).begin(), sequences[i].row(t).end(), batch.row(offset(i) + t).begin());
+        }
+    }
+    return batch;
+}
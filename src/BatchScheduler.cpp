@@ -0,0 +1,66 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe BatchScheduler é definida
+#include "../include/BatchScheduler.hpp"
+
+// Inclui std::max
+#include <algorithm>
+
+// Construtor que define o orçamento, a largura dos buckets e o modo
+BatchScheduler::BatchScheduler(std::size_t token_budget, std::size_t bucket_width, bool packed)
+    : token_budget(std::max<std::size_t>(token_budget, 1)), bucket_width(std::max<std::size_t>(bucket_width, 1)), packed(packed) {}
+
+// Função que retorna o número de posições que o exemplo ocupa no lote: as linhas da entrada já codificada, que a
+// codificação posicional trunca no comprimento máximo, ou o número de tokens se o exemplo não foi preparado
+std::size_t BatchScheduler::encodedLength(const Example& example) {
+    return example.encoded_input.rows() > 0 ? example.encoded_input.rows() : example.input_tokens.size();
+}
+
+// Função que forma o próximo lote
+bool BatchScheduler::next(DatasetStream& stream, std::vector<Example>& batch) {
+    batch.clear();
+
+    // Distribui os exemplos do stream pelos buckets até algum deles completar um lote
+    Example example;
+    while (stream.next(example)) {
+        const std::size_t length = encodedLength(example);
+        Bucket& bucket = buckets[packed || length == 0 ? 0 : (length - 1) / bucket_width];
+
+        // Se o exemplo estouraria o orçamento, o bucket sai como está e o exemplo começa o próximo lote
+        const bool overflow = !bucket.examples.empty() &&
+            positions(bucket.examples.size() + 1, std::max(bucket.max_len, length), bucket.tokens + length) > token_budget;
+        if (overflow) {
+            emit(bucket, batch);
+        }
+        bucket.examples.push_back(std::move(example));
+        bucket.max_len = std::max(bucket.max_len, length);
+        bucket.tokens += length;
+        if (overflow) {
+            return true;
+        }
+
+        // Um bucket que já usa o orçamento inteiro não tem espaço para mais ninguém
+        if (positions(bucket.examples.size(), bucket.max_len, bucket.tokens) >= token_budget) {
+            emit(bucket, batch);
+            return true;
+        }
+    }
+
+    // Fim do stream: esvazia os buckets restantes, do mais curto ao mais longo
+    for (auto& [index, bucket] : buckets) {
+        if (!bucket.examples.empty()) {
+            emit(bucket, batch);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Função que move os exemplos do bucket para o lote
+void BatchScheduler::emit(Bucket& bucket, std::vector<Example>& batch) {
+    batch = std::move(bucket.examples);
+    bucket.examples.clear();
+    bucket.max_len = 0;
+    bucket.tokens = 0;
+}
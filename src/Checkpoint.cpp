@@ -0,0 +1,263 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde as classes de checkpoint são definidas
+#include "../include/Checkpoint.hpp"
+
+// Inclui a biblioteca padrão para manipulação de arquivos
+#include <fstream>
+
+// Inclui std::memcpy e std::memcmp
+#include <cstring>
+
+// Tipo escalar do programa no formato do checkpoint
+static constexpr CheckpointDType realDType() {
+    return sizeof(real_t) == sizeof(float) ? CheckpointDType::Float32 : CheckpointDType::Float64;
+}
+
+// Tamanho em bytes de um elemento
+static std::size_t dtypeSize(CheckpointDType dtype) {
+    switch (dtype) {
+        case CheckpointDType::Float32: return sizeof(float);
+        case CheckpointDType::Float64: return sizeof(double);
+        case CheckpointDType::Int32: return sizeof(int32_t);
+        case CheckpointDType::UInt64: return sizeof(uint64_t);
+        default: return 1;
+    }
+}
+
+// Arredonda um deslocamento para o próximo múltiplo de CHECKPOINT_ALIGNMENT
+static uint64_t alignOffset(uint64_t offset) {
+    return (offset + CHECKPOINT_ALIGNMENT - 1) / CHECKPOINT_ALIGNMENT * CHECKPOINT_ALIGNMENT;
+}
+
+// Função que valida o nome e registra uma seção
+void CheckpointWriter::add(Entry entry) {
+    if (entry.name.size() >= CHECKPOINT_NAME_SIZE) {
+        throw std::invalid_argument("CheckpointWriter: nome de seção longo demais: " + entry.name);
+    }
+    entries.push_back(std::move(entry));
+}
+
+// Função que adiciona uma matriz ao checkpoint
+void CheckpointWriter::addTensor(const std::string& name, ConstTensorView tensor) {
+    add({name, realDType(), tensor, {}, {}});
+}
+
+// Função que adiciona um vetor ao checkpoint
+void CheckpointWriter::addVector(const std::string& name, std::span<const real_t> values) {
+    addTensor(name, ConstTensorView(values.data(), 1, values.size()));
+}
+
+// Função que adiciona bytes arbitrários ao checkpoint
+void CheckpointWriter::addBytes(const std::string& name, std::vector<char> bytes) {
+    add({name, CheckpointDType::Bytes, {}, std::move(bytes), {}});
+}
+
+// Visão em bytes de um array
+template <typename T>
+static std::span<const char> asChars(std::span<const T> values) {
+    return std::span<const char>(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+}
+
+// Funções que adicionam arrays de inteiros ao checkpoint
+void CheckpointWriter::addArray(const std::string& name, std::span<const int32_t> values) {
+    add({name, CheckpointDType::Int32, {}, {}, asChars(values)});
+}
+void CheckpointWriter::addArray(const std::string& name, std::span<const uint64_t> values) {
+    add({name, CheckpointDType::UInt64, {}, {}, asChars(values)});
+}
+
+// Função que grava o checkpoint
+void CheckpointWriter::write(const std::string& path) const {
+
+    // Monta a tabela de seções, com cada seção começando em um deslocamento alinhado
+    std::vector<CheckpointSection> table(entries.size());
+    uint64_t offset = alignOffset(sizeof(CheckpointHeader) + table.size() * sizeof(CheckpointSection));
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        CheckpointSection& section = table[i];
+        std::memset(&section, 0, sizeof(section));
+        std::memcpy(section.name, entry.name.c_str(), entry.name.size());
+        section.dtype = entry.dtype;
+        if (entry.dtype == CheckpointDType::Bytes) {
+            section.rows = 1;
+            section.cols = entry.bytes.size();
+            section.bytes = entry.bytes.size();
+        } else if (entry.dtype == CheckpointDType::Int32 || entry.dtype == CheckpointDType::UInt64) {
+            section.rows = 1;
+            section.cols = entry.array.size() / dtypeSize(entry.dtype);
+            section.bytes = entry.array.size();
+        } else {
+            section.rows = entry.view.rows();
+            section.cols = entry.view.cols();
+            section.bytes = section.rows * section.cols * sizeof(real_t);
+        }
+        section.offset = offset;
+        offset = alignOffset(offset + section.bytes);
+    }
+
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.section_count = static_cast<uint32_t>(table.size());
+    header.section_table_offset = sizeof(CheckpointHeader);
+    header.file_size = offset;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("CheckpointWriter: não foi possível criar " + path);
+    }
+
+    // Escreve zeros até o próximo deslocamento alinhado
+    uint64_t position = 0;
+    auto padTo = [&](uint64_t target) {
+        static const char zeros[CHECKPOINT_ALIGNMENT] = {};
+        while (position < target) {
+            std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(target - position, sizeof(zeros)));
+            file.write(zeros, count);
+            position += count;
+        }
+    };
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(CheckpointSection));
+    position = sizeof(header) + table.size() * sizeof(CheckpointSection);
+
+    // Escreve os dados de cada seção (linha a linha, para aceitar views com stride)
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        padTo(table[i].offset);
+        const Entry& entry = entries[i];
+        if (entry.dtype == CheckpointDType::Bytes) {
+            file.write(entry.bytes.data(), entry.bytes.size());
+        } else if (!entry.array.empty()) {
+            file.write(entry.array.data(), entry.array.size());
+        } else {
+            for (std::size_t r = 0; r < entry.view.rows(); ++r) {
+                std::span<const real_t> row = entry.view.row(r);
+                file.write(reinterpret_cast<const char*>(row.data()), row.size_bytes());
+            }
+        }
+        position += table[i].bytes;
+    }
+    padTo(header.file_size);
+
+    if (!file) {
+        throw std::runtime_error("CheckpointWriter: falha ao gravar " + path);
+    }
+}
+
+// Construtor que mapeia e valida o checkpoint
+CheckpointReader::CheckpointReader(const std::string& path) : file(MappedFile::open(path)) {
+    const char* base = file->data();
+
+    // Valida o cabeçalho
+    CheckpointHeader header;
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("CheckpointReader: arquivo pequeno demais: " + path);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("CheckpointReader: " + path + " não é um checkpoint");
+    }
+    if (header.version != CHECKPOINT_VERSION) {
+        throw std::runtime_error("CheckpointReader: versão " + std::to_string(header.version) + " não suportada em " + path);
+    }
+    // As somas são comparadas com o espaço restante (e os produtos por divisão) para que valores forjados não
+    // estourem uint64 e passem pela validação
+    const uint64_t size = file->size();
+    if (header.file_size != size || header.section_table_offset > size ||
+        uint64_t(header.section_count) > (size - header.section_table_offset) / sizeof(CheckpointSection)) {
+        throw std::runtime_error("CheckpointReader: arquivo truncado: " + path);
+    }
+    if (header.section_table_offset % alignof(CheckpointSection) != 0) {
+        throw std::runtime_error("CheckpointReader: tabela de seções desalinhada em " + path);
+    }
+
+    // A tabela de seções é usada direto do mapeamento
+    sections = reinterpret_cast<const CheckpointSection*>(base + header.section_table_offset);
+    for (std::size_t i = 0; i < header.section_count; ++i) {
+        const CheckpointSection& section = sections[i];
+        const uint64_t element_size = dtypeSize(section.dtype);
+        if (section.offset % CHECKPOINT_ALIGNMENT != 0 || section.offset > size || section.bytes > size - section.offset ||
+            section.bytes % element_size != 0 || (section.rows != 0 && section.cols > section.bytes / element_size / section.rows) ||
+            section.rows * section.cols * element_size != section.bytes) {
+            throw std::runtime_error("CheckpointReader: seção inválida em " + path);
+        }
+        index.emplace(std::string(section.name, strnlen(section.name, CHECKPOINT_NAME_SIZE)), i);
+    }
+}
+
+// Função que indica se a seção existe
+bool CheckpointReader::contains(const std::string& name) const {
+    return index.count(name) > 0;
+}
+
+// Função que procura uma seção pelo nome
+const CheckpointSection& CheckpointReader::find(const std::string& name) const {
+    auto it = index.find(name);
+    if (it == index.end()) {
+        throw std::runtime_error("CheckpointReader: seção não encontrada: " + name);
+    }
+    return sections[it->second];
+}
+
+// Função que retorna uma matriz do checkpoint, sem cópia quando o tipo escalar coincide
+Tensor CheckpointReader::tensor(const std::string& name, std::size_t rows, std::size_t cols) const {
+    const CheckpointSection& section = find(name);
+    if (section.dtype != CheckpointDType::Float32 && section.dtype != CheckpointDType::Float64) {
+        throw std::runtime_error("CheckpointReader: " + name + " não é um tensor");
+    }
+    if (section.rows != rows || section.cols != cols) {
+        throw std::runtime_error("CheckpointReader: " + name + " tem " + std::to_string(section.rows) + " x " +
+                                 std::to_string(section.cols) + ", esperado " + std::to_string(rows) + " x " + std::to_string(cols));
+    }
+    char* data = file->data() + section.offset;
+
+    // Mesmo tipo escalar: o tensor usa o arquivo mapeado diretamente
+    if (section.dtype == realDType()) {
+        return Tensor::borrow(reinterpret_cast<real_t*>(data), rows, cols, file);
+    }
+
+    // Tipo diferente (por exemplo, checkpoint em double lido por um programa em float): converte
+    Tensor converted(rows, cols);
+    for (std::size_t i = 0; i < rows * cols; ++i) {
+        if (section.dtype == CheckpointDType::Float32) {
+            converted.data()[i] = static_cast<real_t>(reinterpret_cast<const float*>(data)[i]);
+        } else {
+            converted.data()[i] = static_cast<real_t>(reinterpret_cast<const double*>(data)[i]);
+        }
+    }
+    return converted;
+}
+
+// Função que retorna um vetor do checkpoint
+std::vector<real_t> CheckpointReader::vector(const std::string& name, std::size_t size) const {
+    Tensor values = tensor(name, 1, size);
+    return std::vector<real_t>(values.data(), values.data() + size);
+}
+
+// Função que retorna os bytes de uma seção
+std::span<const char> CheckpointReader::bytes(const std::string& name) const {
+    const CheckpointSection& section = find(name);
+    return std::span<const char>(file->data() + section.offset, section.bytes);
+}
+
+// Função que retorna um array de int32 do checkpoint
+std::span<const int32_t> CheckpointReader::int32Array(const std::string& name) const {
+    const CheckpointSection& section = find(name);
+    if (section.dtype != CheckpointDType::Int32) {
+        throw std::runtime_error("CheckpointReader: " + name + " não é um array de int32");
+    }
+    return std::span<const int32_t>(reinterpret_cast<const int32_t*>(file->data() + section.offset), section.rows * section.cols);
+}
+
+// Função que retorna um array de uint64 do checkpoint
+std::span<const uint64_t> CheckpointReader::uint64Array(const std::string& name) const {
+    const CheckpointSection& section = find(name);
+    if (section.dtype != CheckpointDType::UInt64) {
+        throw std::runtime_error("CheckpointReader: " + name + " não é um array de uint64");
+    }
+    return std::span<const uint64_t>(reinterpret_cast<const uint64_t*>(file->data() + section.offset), section.rows * section.cols);
+}
@@ -0,0 +1,92 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a estrutura CpuFeatures é definida
+#include "../include/CpuFeatures.hpp"
+
+// Inclui a instrução CPUID (GCC e Clang em x86)
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#define BUMBLEBEE_X86 1
+#endif
+
+#ifdef BUMBLEBEE_X86
+
+// Lê o registrador XCR0, que indica quais estados de registradores o sistema operacional salva
+static unsigned long long readXcr0() {
+    unsigned int eax = 0, edx = 0;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+}
+
+// Consulta o CPUID e preenche as extensões suportadas
+static CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+    // Folha 1: SSE2, AVX, FMA e OSXSAVE
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
+    }
+    features.sse2 = (edx >> 26) & 1;
+    bool osxsave = (ecx >> 27) & 1;
+    bool cpu_avx = (ecx >> 28) & 1;
+    bool cpu_fma = (ecx >> 12) & 1;
+
+    // Sem OSXSAVE o sistema operacional não preserva os registradores YMM/ZMM
+    if (!osxsave) {
+        return features;
+    }
+    unsigned long long xcr0 = readXcr0();
+    bool os_ymm = (xcr0 & 0x6) == 0x6;      // estados XMM e YMM
+    bool os_zmm = (xcr0 & 0xE6) == 0xE6;    // estados XMM, YMM, opmask e ZMM
+
+    features.avx = cpu_avx && os_ymm;
+    features.fma = cpu_fma && os_ymm;
+
+    // Folha 7, subfolha 0: AVX2 e família AVX-512
+    if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        features.avx2 = features.avx && ((ebx >> 5) & 1);
+        features.avx512f = os_zmm && ((ebx >> 16) & 1);
+        features.avx512bw = features.avx512f && ((ebx >> 30) & 1);
+        features.avx512vl = features.avx512f && ((ebx >> 31) & 1);
+        features.avx512vnni = features.avx512f && ((ecx >> 11) & 1);
+    }
+
+    // Folha 7, subfolha 1: AVX-VNNI (VNNI com codificação VEX, 256 bits)
+    if (__get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx)) {
+        features.avxvnni = features.avx2 && ((eax >> 4) & 1);
+    }
+
+    return features;
+}
+
+#else
+
+// Fora de x86 nenhuma extensão é reportada e os kernels escalares são usados
+static CpuFeatures detectCpuFeatures() {
+    return CpuFeatures();
+}
+
+#endif
+
+// Retorna as extensões do processador atual (detectadas uma única vez)
+const CpuFeatures& CpuFeatures::get() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+// Lista as extensões detectadas, para exibição no console
+std::string CpuFeatures::describe() const {
+    std::string text;
+    if (sse2) text += "sse2 ";
+    if (avx) text += "avx ";
+    if (avx2) text += "avx2 ";
+    if (fma) text += "fma ";
+    if (avx512f) text += "avx512f ";
+    if (avx512bw) text += "avx512bw ";
+    if (avx512vl) text += "avx512vl ";
+    if (avx512vnni) text += "avx512vnni ";
+    if (avxvnni) text += "avxvnni ";
+    return text.empty() ? "scalar" : text.substr(0, text.size() - 1);
+}
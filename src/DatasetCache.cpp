@@ -0,0 +1,59 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe DatasetCache é definida
+#include "../include/DatasetCache.hpp"
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Inclui std::numeric_limits
+#include <limits>
+
+// Os IDs são gravados como int32 e lidos como int
+static_assert(sizeof(int) == sizeof(int32_t), "DatasetCache assume int de 32 bits");
+
+// Função que compila o cache
+void DatasetCache::write(const std::string& path, const Tokenizer& tokenizer, const TokenizedCorpus& corpus, int vocab_size) {
+
+    // Apenas linhas com par: 2 * pares linhas e 2 * pares + 1 deslocamentos
+    const std::size_t pairs = corpus.lines() / 2;
+    std::span<const uint64_t> offsets(corpus.line_offsets.data(), 2 * pairs + 1);
+    std::span<const int32_t> tokens(reinterpret_cast<const int32_t*>(corpus.tokens.data()), offsets.back());
+    const uint64_t info[2] = {pairs, static_cast<uint64_t>(vocab_size)};
+
+    CheckpointWriter writer;
+    tokenizer.saveVocab(writer);
+    writer.addArray("dataset.info", std::span<const uint64_t>(info));
+    writer.addArray("dataset.offsets", offsets);
+    writer.addArray("dataset.tokens", tokens);
+    writer.write(path);
+}
+
+// Construtor que mapeia o cache e valida o cabeçalho dos índices (em O(1): as linhas são validadas ao serem lidas)
+DatasetCache::DatasetCache(const std::string& path) : reader(path) {
+    std::span<const uint64_t> info = reader.uint64Array("dataset.info");
+    std::span<const int32_t> ids = reader.int32Array("dataset.tokens");
+    offsets = reader.uint64Array("dataset.offsets");
+    if (info.size() != 2 || offsets.size() != 2 * info[0] + 1 || offsets.front() != 0 || offsets.back() != ids.size() ||
+        info[1] > uint64_t(std::numeric_limits<int32_t>::max())) {
+        throw std::runtime_error("DatasetCache: índice inválido em " + path);
+    }
+    tokens = std::span<const int>(reinterpret_cast<const int*>(ids.data()), ids.size());
+    vocab_size = static_cast<int>(info[1]);
+}
+
+// Função que retorna os IDs da linha i, validando seus deslocamentos e IDs (que vão direto para a tabela de
+// embeddings, sem outra verificação)
+std::span<const int> DatasetCache::line(std::size_t i) const {
+    if (offsets[i] > offsets[i + 1] || offsets[i + 1] > tokens.size()) {
+        throw std::runtime_error("DatasetCache: deslocamentos inválidos na linha " + std::to_string(i));
+    }
+    std::span<const int> ids(tokens.data() + offsets[i], offsets[i + 1] - offsets[i]);
+    for (int id : ids) {
+        if (id < 0 || id >= vocab_size) {
+            throw std::runtime_error("DatasetCache: índice inválido na linha " + std::to_string(i));
+        }
+    }
+    return ids;
+}
@@ -0,0 +1,120 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe DatasetStream é definida
+#include "../include/DatasetStream.hpp"
+
+// Inclui a biblioteca padrão para manipulação de arquivos
+#include <fstream>
+
+// Inclui std::shared_ptr
+#include <memory>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Função que tokeniza uma linha em 'tokens' (no modo por palavras, uma linha de n bytes tem no máximo n / 2 + 1 tokens)
+static void tokenizeLine(const Tokenizer& tokenizer, const std::string& line, std::vector<int>& tokens) {
+    tokens.resize(line.size() / 2 + 1);
+    std::size_t count = tokenizer.tokenize(line, tokens);
+    if (count > tokens.size()) {
+        tokens.resize(count);
+        tokenizer.tokenize(line, tokens);
+    }
+    tokens.resize(count);
+}
+
+// Função que cria a fonte de texto
+DatasetStream::Source DatasetStream::fromText(const std::string& path, const Tokenizer& tokenizer) {
+    if (!tokenizer.isBPE() && !tokenizer.isFrozen()) {
+        throw std::logic_error("DatasetStream::fromText: o vocabulário precisa estar congelado ou no modo BPE");
+    }
+    auto file = std::make_shared<std::ifstream>(path);
+    if (!file->is_open()) {
+        throw std::runtime_error("DatasetStream::fromText: não foi possível abrir " + path);
+    }
+
+    // Apenas a linha atual fica em memória; um par incompleto no fim do arquivo é descartado
+    return [file, &tokenizer, line = std::string()](Example& example) mutable {
+        std::vector<int>* targets[2] = {&example.input_tokens, &example.output_tokens};
+        for (std::vector<int>* tokens : targets) {
+            do {
+                if (!std::getline(*file, line)) {
+                    return false;
+                }
+            } while (line.empty());
+            tokenizeLine(tokenizer, line, *tokens);
+        }
+        return true;
+    };
+}
+
+// Função que cria a fonte do cache
+DatasetStream::Source DatasetStream::fromCache(const DatasetCache& cache) {
+    return [&cache, i = std::size_t(0)](Example& example) mutable {
+        if (i == cache.size()) {
+            return false;
+        }
+        std::span<const int> input = cache.input(i);
+        std::span<const int> output = cache.output(i);
+        example.input_tokens.assign(input.begin(), input.end());
+        example.output_tokens.assign(output.begin(), output.end());
+        ++i;
+        return true;
+    };
+}
+
+// Função que cria a fonte de pares em memória
+DatasetStream::Source DatasetStream::fromPairs(const std::vector<std::span<const int>>& inputs, const std::vector<std::span<const int>>& outputs) {
+    return [&inputs, &outputs, i = std::size_t(0)](Example& example) mutable {
+        if (i == inputs.size() || i == outputs.size()) {
+            return false;
+        }
+        example.input_tokens.assign(inputs[i].begin(), inputs[i].end());
+        example.output_tokens.assign(outputs[i].begin(), outputs[i].end());
+        ++i;
+        return true;
+    };
+}
+
+// Construtor que inicia a thread de leitura
+DatasetStream::DatasetStream(Source source, std::size_t capacity, Prepare prepare)
+    : queue(capacity), producer(&DatasetStream::produce, this, std::move(source), std::move(prepare)) {}
+
+// Destrutor que interrompe a leitura
+DatasetStream::~DatasetStream() {
+    queue.close();
+    producer.join();
+}
+
+// Laço da thread de leitura: lê, prepara e enfileira até o fim da fonte, um erro ou o fechamento da fila
+void DatasetStream::produce(Source source, Prepare prepare) {
+    try {
+        while (true) {
+            Example example;
+            if (!source(example)) {
+                break;
+            }
+            if (prepare) {
+                prepare(example);
+            }
+            if (!queue.push(std::move(example))) {
+                break;
+            }
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    queue.close();
+}
+
+// Função que retira o próximo exemplo
+bool DatasetStream::next(Example& example) {
+    if (queue.pop(example)) {
+        return true;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return false;
+}
@@ -4,84 +4,235 @@
 // Inclui o arquivo de cabeçalho onde a classe FinalLayer é definida
 #include "../include/FinalLayer.hpp"
 
+// Inclui o pool de threads que divide as posições entre os núcleos
+#include "../include/ThreadPool.hpp"
+
+// Inclui a arena de onde vêm os logits de cada faixa do vocabulário
+#include "../include/ActivationArena.hpp"
+
+// Inclui std::numeric_limits
+#include <limits>
+
 // Construtor da classe FinalLayer, inicializa os pesos e bias
 FinalLayer::FinalLayer(int input_dim, int output_dim) : input_dim(input_dim), output_dim(output_dim) {
     
     // Inicializa a matriz de pesos W com valores constantes (0.1f)
-    W.resize(output_dim, std::vector<double>(input_dim, 0.1f)); 
+    W.resize(output_dim, input_dim, 0.1f); 
     
     // Inicializa o vetor de bias b com zeros
     b.resize(output_dim, 0.0f); 
 }
 
-// Função que realiza o forward pass: aplica a transformação linear e depois a softmax
-std::vector<double> FinalLayer::forward(const std::vector<double>& input) const {
-    
-    // Primeiro aplica a transformação linear
-    auto z = linear(input);
-    
-    // Em seguida, aplica a softmax para normalizar as saídas
-    return softmax(z);
+// Função que realiza o forward pass: aplica a transformação linear e depois a softmax em cada posição
+Tensor FinalLayer::forward(const Tensor& input) const {
+    Tensor probabilities(input.rows(), output_dim);
+    forward(input, probabilities);
+
+    // Retorna as probabilidades de todas as posições
+    return probabilities;
 }
 
-// Função que aplica a transformação linear (W * input + b)
-std::vector<double> FinalLayer::linear(const std::vector<double>& input) const {
-    
-    // Vetor de saída inicializado com zeros
-    std::vector<double> output(output_dim, 0.0f);
-    
-    // Realiza a multiplicação matriz-vetor e adiciona o bias
-    for (int i = 0; i < output_dim; ++i) {
-        for (int j = 0; j < input_dim; ++j) {
+// Função que realiza o forward pass escrevendo as probabilidades em output
+void FinalLayer::forward(ConstTensorView input, TensorView output) const {
+
+    // Primeiro aplica a transformação linear (uma linha de logits por posição)
+    linear(input, output);
 
-            // Multiplica a entrada pelo peso
-            output[i] += W[i][j] * input[j]; 
+    // Em seguida, aplica a softmax para normalizar as saídas de cada posição (faixas de posições em paralelo)
+    ThreadPool::global().parallelFor(output.rows(), ROW_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            softmax(output.row(i));
         }
+    });
+}
+
+// Função que aplica a transformação linear (input * W^T + b) a todas as posições, escrevendo em output as colunas
+// [first, first + output.cols()) dos logits
+void FinalLayer::linear(ConstTensorView input, TensorView output, size_t first) const {
 
-        // Adiciona o bias ao resultado final
-        output[i] += b[i]; 
+    // Multiplicação de matrizes com o GEMM, com o bias somado no epílogo
+    GemmEpilogue<real_t> epilogue;
+    epilogue.bias = b.data() + first;
+    if (isQuantized()) {
+        VectorMath::gemmInt8(input, W_int8, output, epilogue, first);
+    } else {
+        VectorMath::gemm(input, W.block(first, output.cols(), 0, input_dim), output, true, epilogue);
     }
+}
+
+// Função que calcula a perda de cross-entropy (e, se pedido, o gradiente em relação a input) por faixas do vocabulário
+double FinalLayer::crossEntropy(ConstTensorView input, std::span<const int> targets, std::span<double> losses,
+                                TensorView gradients) const {
+    const size_t rows = input.rows();
+    if (targets.size() != rows || (!losses.empty() && losses.size() != rows) ||
+        (!gradients.empty() && (gradients.rows() != rows || gradients.cols() != static_cast<size_t>(input_dim)))) {
+        throw std::invalid_argument("FinalLayer::crossEntropy: dimensões incompatíveis entre input, targets, losses e gradients.");
+    }
+    for (int target : targets) {
+        if (target >= output_dim) {
+            throw std::out_of_range("FinalLayer::crossEntropy: token alvo fora do vocabulário.");
+        }
+    }
+    if (!gradients.empty() && isQuantized()) {
+        throw std::logic_error("FinalLayer::crossEntropy: pesos quantizados não têm gradiente.");
+    }
+    if (rows == 0) {
+        return 0.0;
+    }
+
+    // Logits de uma faixa e, por posição, o máximo, a soma das exponenciais (relativa ao máximo) e o logit do alvo
+    ActivationArena& scratch = ActivationArena::local();
+    ActivationArena::Scope scope(scratch);
+    const size_t chunk = std::min<size_t>(vocab_chunk, output_dim);
+    TensorView logits = scratch.allocate(rows, chunk);
+    TensorView state = scratch.allocate(rows, 3);
+    for (size_t r = 0; r < rows; ++r) {
+        state(r, 0) = -std::numeric_limits<real_t>::infinity();
+        state(r, 1) = 0;
+        state(r, 2) = 0;
+    }
+
+    // Primeira passada: logsumexp online sobre as faixas do vocabulário
+    for (size_t first = 0; first < static_cast<size_t>(output_dim); first += chunk) {
+        const size_t cols = std::min<size_t>(chunk, output_dim - first);
+        TensorView block = logits.colRange(0, cols);
+        linear(input, block, first);
+
+        ThreadPool::global().parallelFor(rows, ROW_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; ++r) {
+                std::span<const real_t> row = block.row(r);
+
+                // Um máximo maior reescala a soma acumulada até aqui
+                const real_t chunk_max = *std::max_element(row.begin(), row.end());
+                real_t max = state(r, 0);
+                real_t sum = state(r, 1);
+                if (chunk_max > max) {
+                    sum *= std::exp(max - chunk_max);
+                    max = chunk_max;
+                }
+                for (real_t value : row) {
+                    sum += std::exp(value - max);
+                }
+                state(r, 0) = max;
+                state(r, 1) = sum;
 
-    // Retorna o vetor resultante da transformação linear
-    return output; 
+                // Logit do alvo, quando ele cai nesta faixa
+                const int target = targets[r];
+                if (target >= 0 && static_cast<size_t>(target) >= first && static_cast<size_t>(target) < first + cols) {
+                    state(r, 2) = row[target - first];
+                }
+            }
+        });
+    }
+
+    // Perda de cada posição: logsumexp - logit do alvo (state(r, 0) passa a guardar o logsumexp)
+    double total = 0.0;
+    for (size_t r = 0; r < rows; ++r) {
+        state(r, 0) += std::log(state(r, 1));
+        const double loss = targets[r] >= 0 ? double(state(r, 0)) - state(r, 2) : 0.0;
+        if (!losses.empty()) {
+            losses[r] = loss;
+        }
+        total += loss;
+    }
+    if (gradients.empty()) {
+        return total;
+    }
+
+    // Segunda passada: refaz os logits de cada faixa, transforma-os em softmax - one_hot e acumula o produto por W
+    for (size_t first = 0; first < static_cast<size_t>(output_dim); first += chunk) {
+        const size_t cols = std::min<size_t>(chunk, output_dim - first);
+        TensorView block = logits.colRange(0, cols);
+        linear(input, block, first);
+
+        ThreadPool::global().parallelFor(rows, ROW_PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; ++r) {
+                std::span<real_t> row = block.row(r);
+                const int target = targets[r];
+                if (target < 0) {
+                    std::fill(row.begin(), row.end(), real_t(0));
+                    continue;
+                }
+                const real_t log_sum = state(r, 0);
+                for (real_t& value : row) {
+                    value = std::exp(value - log_sum);
+                }
+                if (static_cast<size_t>(target) >= first && static_cast<size_t>(target) < first + cols) {
+                    row[target - first] -= 1;
+                }
+            }
+        });
+
+        // gradients (+)= (softmax - one_hot) da faixa * linhas da faixa em W
+        VectorMath::gemm(ConstTensorView(block), W.block(first, cols, 0, input_dim), gradients, false, real_t(1),
+                         first == 0 ? real_t(0) : real_t(1));
+    }
+    return total;
 }
 
 // Função que atualiza os parâmetros (pesos W) com base nos gradientes e taxa de aprendizado
-void FinalLayer::updateParameters(std::vector<double>& gradients, int index, double learning_rate) {
+void FinalLayer::updateParameters(std::span<const real_t> gradients, int index, double learning_rate) {
     
+    // Os pesos INT8 são apenas para inferência
+    if (isQuantized()) {
+        throw std::logic_error("FinalLayer::updateParameters: pesos quantizados não podem ser treinados.");
+    }
+
     // Atualiza os pesos da linha correspondente ao índice "index" com base nos gradientes
-    for (size_t j = 0; j < W[index].size(); ++j) {
+    std::span<real_t> weights = W.row(index);
+    for (size_t j = 0; j < weights.size(); ++j) {
 
         // Atualiza o peso W com base no gradiente
-        W[index][j] -= learning_rate * gradients[j];  
+        weights[j] -= learning_rate * gradients[j];  
     }
 }
 
+// Função que quantiza W em INT8 e libera a versão em ponto flutuante
+void FinalLayer::quantizeWeights() {
+    W_int8 = QuantizedMatrix::quantize(W);
+    W = Tensor();
+}
+
+// Função que retorna a memória ocupada pelos pesos e pelo bias
+size_t FinalLayer::weightBytes() const {
+    return (W.size() + b.size()) * sizeof(real_t) + W_int8.bytes();
+}
+
+// Função que salva os pesos e o bias no checkpoint
+void FinalLayer::saveParameters(CheckpointWriter& writer, const std::string& prefix) const {
+    if (isQuantized()) {
+        throw std::logic_error("FinalLayer::saveParameters: pesos quantizados não podem ser salvos.");
+    }
+    writer.addTensor(prefix + ".W", W);
+    writer.addVector(prefix + ".b", b);
+}
+
+// Função que carrega os pesos e o bias do checkpoint (descartando uma eventual versão INT8)
+void FinalLayer::loadParameters(const CheckpointReader& reader, const std::string& prefix) {
+    W = reader.tensor(prefix + ".W", output_dim, input_dim);
+    b = reader.vector(prefix + ".b", output_dim);
+    W_int8 = QuantizedMatrix();
+}
+
 // Função que aplica a softmax para normalizar as saídas em forma de probabilidades
-std::vector<double> FinalLayer::softmax(const std::vector<double>& input) const {
-    
-    // Vetor de saída inicializado com zeros
-    std::vector<double> output(input.size(), 0.0f);
+void FinalLayer::softmax(std::span<real_t> values) const {
     
     // Encontra o valor máximo da entrada para estabilidade numérica (evitar overflow)
-    double maxElement = *max_element(input.begin(), input.end());
+    real_t maxElement = *std::max_element(values.begin(), values.end());
     
     // Soma acumulada para normalizar a softmax
-    double sum = 0.0f;
+    real_t sum = 0;
 
     // Aplica a função exponencial ao input e calcula a soma
-    for (size_t i = 0; i < input.size(); ++i) {
+    for (size_t i = 0; i < values.size(); ++i) {
 
         // Subtrai o máximo para estabilidade
-        output[i] = std::exp(input[i] - maxElement); 
-        sum += output[i];
+        values[i] = std::exp(values[i] - maxElement); 
+        sum += values[i];
     }
 
     // Divide cada elemento da softmax pela soma total para normalizar
-    for (size_t i = 0; i < input.size(); ++i) {
-        output[i] /= sum;
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] /= sum;
     }
-
-    // Retorna o vetor normalizado
-    return output; 
 }
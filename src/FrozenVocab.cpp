@@ -0,0 +1,228 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe FrozenVocab é definida
+#include "../include/FrozenVocab.hpp"
+
+// Inclui std::memcmp
+#include <cstring>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Inclui a biblioteca padrão para manipulação de arquivos
+#include <fstream>
+
+// Inclui o mapeamento de arquivos em memória
+#include "../include/MappedFile.hpp"
+
+// Constantes do hash FNV-1a de 64 bits
+static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+// Indica se um byte é espaço em branco (mesmo critério de std::isspace no locale "C", usado por operator>>)
+static bool isSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Função que calcula o hash de uma palavra
+uint64_t FrozenVocab::hash(std::string_view word) {
+    uint64_t h = FNV_OFFSET;
+    for (unsigned char c : word) {
+        h = (h ^ c) * FNV_PRIME;
+    }
+    return h;
+}
+
+// Função que constrói o vocabulário
+FrozenVocab FrozenVocab::build(const std::vector<std::string>& words_by_id) {
+    FrozenVocab vocab;
+
+    // Os dados ficam em vetores próprios, compartilhados entre as cópias do vocabulário
+    struct Storage {
+        std::vector<char> arena;
+        std::vector<uint32_t> offsets;
+        std::vector<Slot> slots;
+    };
+    auto storage = std::make_shared<Storage>();
+
+    // Arena de caracteres e deslocamentos
+    std::vector<std::string_view> words(words_by_id.begin(), words_by_id.end());
+    bool has_unknown = false;
+    for (std::string_view word : words) {
+        has_unknown = has_unknown || word == UNKNOWN_TOKEN;
+    }
+    if (!has_unknown) {
+        words.push_back(UNKNOWN_TOKEN);
+    }
+    storage->offsets.reserve(words.size() + 1);
+    storage->offsets.push_back(0);
+    for (std::string_view word : words) {
+        storage->arena.insert(storage->arena.end(), word.begin(), word.end());
+        storage->offsets.push_back(static_cast<uint32_t>(storage->arena.size()));
+    }
+
+    // Tabela hash com pelo menos o dobro de posições que palavras
+    std::size_t capacity = 16;
+    while (capacity < 2 * words.size()) {
+        capacity *= 2;
+    }
+    storage->slots.assign(capacity, Slot{0, -1});
+    vocab.arena = storage->arena;
+    vocab.offsets = storage->offsets;
+    vocab.slots = storage->slots;
+    vocab.mask = capacity - 1;
+    for (int id = 0; id < static_cast<int>(words.size()); ++id) {
+        uint64_t h = hash(words[id]);
+        if (vocab.find(words[id], h) >= 0) {
+            throw std::invalid_argument("FrozenVocab::build: palavra repetida: " + std::string(words[id]));
+        }
+        uint64_t position = h & vocab.mask;
+        while (storage->slots[position].id >= 0) {
+            position = (position + 1) & vocab.mask;
+        }
+        storage->slots[position] = Slot{static_cast<uint32_t>(h >> 32), id};
+    }
+
+    vocab.unk_id = vocab.find(UNKNOWN_TOKEN);
+    vocab.owner = std::move(storage);
+    return vocab;
+}
+
+// Função que grava o vocabulário no formato binário
+void FrozenVocab::save(const std::string& path) const {
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, VOCAB_MAGIC, sizeof(header.magic));
+    header.version = VOCAB_VERSION;
+    header.word_count = static_cast<uint32_t>(size());
+    header.slot_count = static_cast<uint32_t>(slots.size());
+    header.unk_id = unk_id;
+    header.arena_bytes = arena.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("FrozenVocab::save: não foi possível criar " + path);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(offsets.data()), offsets.size_bytes());
+    file.write(reinterpret_cast<const char*>(slots.data()), slots.size_bytes());
+    file.write(arena.data(), arena.size_bytes());
+    if (!file) {
+        throw std::runtime_error("FrozenVocab::save: falha ao gravar " + path);
+    }
+}
+
+// Função que mapeia um vocabulário binário
+FrozenVocab FrozenVocab::load(const std::string& path) {
+    std::shared_ptr<MappedFile> file = MappedFile::open(path);
+    const char* base = file->data();
+
+    // Valida o cabeçalho e os tamanhos das tabelas
+    Header header;
+    if (file->size() < sizeof(header)) {
+        throw std::runtime_error("FrozenVocab::load: arquivo pequeno demais: " + path);
+    }
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, VOCAB_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("FrozenVocab::load: " + path + " não é um vocabulário binário");
+    }
+    if (header.version != VOCAB_VERSION) {
+        throw std::runtime_error("FrozenVocab::load: versão " + std::to_string(header.version) + " não suportada em " + path);
+    }
+    const uint64_t offsets_bytes = (uint64_t(header.word_count) + 1) * sizeof(uint32_t);
+    const uint64_t slots_bytes = uint64_t(header.slot_count) * sizeof(Slot);
+    if (sizeof(header) + offsets_bytes + slots_bytes + header.arena_bytes != file->size() ||
+        header.slot_count == 0 || (header.slot_count & (header.slot_count - 1)) != 0 ||
+        header.slot_count <= header.word_count || header.unk_id < 0 || uint32_t(header.unk_id) >= header.word_count) {
+        throw std::runtime_error("FrozenVocab::load: arquivo inválido: " + path);
+    }
+
+    // As tabelas são usadas direto do mapeamento
+    FrozenVocab vocab;
+    vocab.offsets = std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(base + sizeof(header)), header.word_count + 1);
+    vocab.slots = std::span<const Slot>(reinterpret_cast<const Slot*>(base + sizeof(header) + offsets_bytes), header.slot_count);
+    vocab.arena = std::span<const char>(base + sizeof(header) + offsets_bytes + slots_bytes, header.arena_bytes);
+    if (vocab.offsets.front() != 0 || vocab.offsets.back() != header.arena_bytes) {
+        throw std::runtime_error("FrozenVocab::load: arquivo inválido: " + path);
+    }
+
+    // Os deslocamentos internos e os IDs da tabela hash são usados sem verificação em find() e na detokenização:
+    // os deslocamentos precisam ser crescentes dentro da arena, cada posição precisa estar vazia (-1) ou ter um ID
+    // válido, e ao menos uma posição vazia garante que a busca termina
+    for (uint32_t i = 0; i < header.word_count; ++i) {
+        if (vocab.offsets[i] > vocab.offsets[i + 1] || vocab.offsets[i + 1] > header.arena_bytes) {
+            throw std::runtime_error("FrozenVocab::load: arquivo inválido: " + path);
+        }
+    }
+    bool has_empty_slot = false;
+    for (const Slot& slot : vocab.slots) {
+        if (slot.id < -1 || (slot.id >= 0 && uint32_t(slot.id) >= header.word_count)) {
+            throw std::runtime_error("FrozenVocab::load: arquivo inválido: " + path);
+        }
+        has_empty_slot = has_empty_slot || slot.id == -1;
+    }
+    if (!has_empty_slot) {
+        throw std::runtime_error("FrozenVocab::load: arquivo inválido: " + path);
+    }
+    vocab.mask = header.slot_count - 1;
+    vocab.unk_id = header.unk_id;
+    vocab.owner = std::move(file);
+    return vocab;
+}
+
+// Função que busca uma palavra com o hash já calculado
+int FrozenVocab::find(std::string_view word, uint64_t word_hash) const {
+    if (slots.empty()) {
+        return -1;
+    }
+    const uint32_t tag = static_cast<uint32_t>(word_hash >> 32);
+    for (uint64_t position = word_hash & mask;; position = (position + 1) & mask) {
+        const Slot& slot = slots[position];
+        if (slot.id < 0) {
+            return -1;
+        }
+
+        // A string só é comparada quando a parte guardada do hash e o tamanho coincidem
+        if (slot.tag == tag) {
+            uint32_t begin = offsets[slot.id], length = offsets[slot.id + 1] - begin;
+            if (length == word.size() && std::memcmp(arena.data() + begin, word.data(), length) == 0) {
+                return slot.id;
+            }
+        }
+    }
+}
+
+// Função que converte um texto em IDs sem alocar: o hash de cada palavra é calculado durante a própria varredura
+std::size_t FrozenVocab::tokenize(std::string_view text, std::span<int> output) const {
+    std::size_t count = 0;
+    const char* data = text.data();
+    const std::size_t size = text.size();
+    std::size_t position = 0;
+    while (true) {
+
+        // Pula os espaços
+        while (position < size && isSpace(static_cast<unsigned char>(data[position]))) {
+            ++position;
+        }
+        if (position == size) {
+            break;
+        }
+
+        // Percorre a palavra calculando o hash
+        std::size_t begin = position;
+        uint64_t h = FNV_OFFSET;
+        while (position < size && !isSpace(static_cast<unsigned char>(data[position]))) {
+            h = (h ^ static_cast<unsigned char>(data[position])) * FNV_PRIME;
+            ++position;
+        }
+
+        // Escreve o ID (ou <unk>) se ainda houver espaço no buffer
+        if (count < output.size()) {
+            int token = find(std::string_view(data + begin, position - begin), h);
+            output[count] = token < 0 ? unk_id : token;
+        }
+        ++count;
+    }
+    return count;
+}
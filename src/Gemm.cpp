@@ -0,0 +1,363 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+// Motor de GEMM empacotado e bloqueado para cache (no estilo BLIS/GotoBLAS):
+// B é copiado em painéis de NR colunas que cabem no L2/L3, A em painéis de MR linhas que cabem no L2,
+// e o micro-kernel da ISA escolhida em tempo de execução percorre os painéis mantendo o bloco de C em registradores.
+
+// Inclui o arquivo de cabeçalho onde a classe VectorMath é definida
+#include "../include/VectorOp.hpp"
+
+// Inclui as declarações dos micro-kernels
+#include "../include/GemmKernels.hpp"
+
+// Inclui a detecção de extensões do processador
+#include "../include/CpuFeatures.hpp"
+
+// Inclui o pool de threads que divide os blocos do GEMM entre os núcleos
+#include "../include/ThreadPool.hpp"
+
+// Inclui std::getenv
+#include <cstdlib>
+
+// Inclui std::strcmp
+#include <cstring>
+
+// Tamanhos de bloco do GEMM: KC x NR de B fica no L1, MC x KC de A no L2 e KC x NC de B no L3.
+// GEMM_KC_BYTES mantém os painéis com o mesmo tamanho em bytes: KC = 256 em precisão dupla e 512 em precisão simples.
+static constexpr std::size_t GEMM_KC_BYTES = 2048;
+static constexpr std::size_t GEMM_MC = 96;
+static constexpr std::size_t GEMM_NC = 3072;
+
+// Com até GEMM_DOT_ROWS linhas em A e B transposta (pesos no formato saída x entrada), o empacotamento não compensa
+static constexpr std::size_t GEMM_DOT_ROWS = 2;
+
+// Maior bloco de registradores entre todos os micro-kernels (usado nos blocos de borda)
+static constexpr std::size_t GEMM_MAX_TILE = 8 * 48;
+
+// A partir de m * n * k multiplicações o GEMM divide o trabalho entre as threads do pool global; abaixo disso,
+// o custo de despachar as tarefas é maior que o ganho (e chamadas pequenas costumam vir de tarefas já paralelas)
+static constexpr std::size_t GEMM_PARALLEL_MIN_WORK = std::size_t(1) << 18;
+
+// Colunas por tarefa no caminho de produtos escalares paralelo
+static constexpr std::size_t GEMM_DOT_GRAIN = 64;
+
+// Escolhe o melhor conjunto de kernels suportado pelo processador (ou o forçado por BUMBLEBEE_GEMM_ISA)
+static const GemmBackend* selectGemmBackend() {
+    const CpuFeatures& cpu = CpuFeatures::get();
+
+    // Candidatos em ordem de preferência, cada um com a condição de suporte
+    struct Candidate { const GemmBackend* backend; bool supported; };
+    const Candidate candidates[] = {
+        {gemmBackendAVX512(), cpu.avx512f},
+        {gemmBackendAVX2(), cpu.avx2 && cpu.fma},
+        {gemmBackendSSE2(), cpu.sse2},
+        {gemmBackendScalar(), true},
+    };
+
+    // Permite forçar uma ISA (útil para comparar kernels e para depuração)
+    const char* forced = std::getenv("BUMBLEBEE_GEMM_ISA");
+    if (forced != nullptr && *forced != '\0') {
+        for (const Candidate& candidate : candidates) {
+            if (candidate.backend != nullptr && std::strcmp(candidate.backend->name, forced) == 0) {
+                if (candidate.supported) {
+                    return candidate.backend;
+                }
+                break;
+            }
+        }
+        std::cerr << "BUMBLEBEE_GEMM_ISA=" << forced << " indisponivel; usando a deteccao automatica." << std::endl;
+    }
+
+    for (const Candidate& candidate : candidates) {
+        if (candidate.backend != nullptr && candidate.supported) {
+            return candidate.backend;
+        }
+    }
+    return gemmBackendScalar();
+}
+
+// Retorna o conjunto de kernels escolhido (decidido uma única vez)
+static const GemmBackend& gemmKernels() {
+    static const GemmBackend* backend = selectGemmBackend();
+    return *backend;
+}
+
+// Buffer de empacotamento alinhado, reaproveitado entre chamadas da mesma thread
+template <typename T>
+static T* packBuffer(std::vector<T, AlignedAllocator<T>>& buffer, std::size_t size) {
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+    return buffer.data();
+}
+
+// Empacota o bloco de A (linhas [i0, i0 + mc), colunas [p0, p0 + kc)) em painéis de MR linhas, já multiplicado por alpha.
+// Linhas que faltam no último painel são preenchidas com zero.
+template <typename T>
+static void packA(MatrixView<const T> a, std::size_t i0, std::size_t mc, std::size_t p0, std::size_t kc, std::size_t mr, T alpha, T* packed) {
+    for (std::size_t ir = 0; ir < mc; ir += mr) {
+        std::size_t rows = std::min(mr, mc - ir);
+        for (std::size_t i = 0; i < mr; ++i) {
+            if (i < rows) {
+                const T* src = &a(i0 + ir + i, p0);
+                for (std::size_t p = 0; p < kc; ++p) {
+                    packed[p * mr + i] = alpha * src[p];
+                }
+            } else {
+                for (std::size_t p = 0; p < kc; ++p) {
+                    packed[p * mr + i] = T(0);
+                }
+            }
+        }
+        packed += mr * kc;
+    }
+}
+
+// Empacota o bloco de op(B) (linhas [p0, p0 + kc), colunas [j0, j0 + nc)) em painéis de NR colunas.
+// Com transpose_b, op(B)(p, j) = B(j, p): cada coluna do painel é um trecho contíguo de uma linha de B.
+template <typename T>
+static void packB(MatrixView<const T> b, bool transpose_b, std::size_t p0, std::size_t kc, std::size_t j0, std::size_t nc, std::size_t nr, T* packed) {
+    for (std::size_t jr = 0; jr < nc; jr += nr) {
+        std::size_t cols = std::min(nr, nc - jr);
+        if (transpose_b) {
+            for (std::size_t j = 0; j < nr; ++j) {
+                if (j < cols) {
+                    const T* src = &b(j0 + jr + j, p0);
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        packed[p * nr + j] = src[p];
+                    }
+                } else {
+                    for (std::size_t p = 0; p < kc; ++p) {
+                        packed[p * nr + j] = T(0);
+                    }
+                }
+            }
+        } else {
+            for (std::size_t p = 0; p < kc; ++p) {
+                const T* src = &b(p0 + p, j0 + jr);
+                T* dst = packed + p * nr;
+                std::size_t j = 0;
+                for (; j < cols; ++j) {
+                    dst[j] = src[j];
+                }
+                for (; j < nr; ++j) {
+                    dst[j] = T(0);
+                }
+            }
+        }
+        packed += nr * kc;
+    }
+}
+
+// Driver do GEMM: C = alpha * A * op(B) + beta * C, seguido de 'epilogue' em cada bloco de C que fica pronto
+template <typename T>
+static void gemmDriver(const GemmMicroKernel<T>& kernel, MatrixView<const T> a, MatrixView<const T> b, MatrixView<T> c, bool transpose_b, T alpha, T beta,
+                       const GemmEpilogue<T>& epilogue) {
+    const std::size_t m = a.rows();
+    const std::size_t k = a.cols();
+    const std::size_t n = c.cols();
+
+    // Valida as dimensões de A, op(B) e C
+    const std::size_t b_rows = transpose_b ? b.cols() : b.rows();
+    const std::size_t b_cols = transpose_b ? b.rows() : b.cols();
+    if (b_rows != k || b_cols != n || c.rows() != m) {
+        throw std::invalid_argument("VectorMath::gemm: dimensões incompatíveis entre A, B e C.");
+    }
+
+    // Valida o epílogo: com SwiGLU, C tem pares (gate, up) e o resultado tem metade das colunas
+    const bool swiglu = epilogue.activation == ActivationFunction::SwiGLU;
+    const std::size_t result_cols = swiglu ? n / 2 : n;
+    if ((swiglu && (n % 2 != 0 || epilogue.gated.rows() != m || epilogue.gated.cols() != result_cols)) ||
+        (!epilogue.residual.empty() && (epilogue.residual.rows() != m || epilogue.residual.cols() != result_cols))) {
+        throw std::invalid_argument("VectorMath::gemm: dimensões incompatíveis entre C e o epílogo.");
+    }
+
+    // Aplica beta em C uma única vez (beta == 0 sobrescreve, inclusive eventuais NaN)
+    if (beta != T(1)) {
+        for (std::size_t i = 0; i < m; ++i) {
+            for (T& value : c.row(i)) {
+                value = (beta == T(0)) ? T(0) : beta * value;
+            }
+        }
+    }
+    if (m == 0 || n == 0) {
+        return;
+    }
+    if (k == 0 || alpha == T(0)) {
+        if (epilogue.active()) {
+            for (std::size_t i = 0; i < m; ++i) {
+                epilogue.apply(i, 0, &c(i, 0), n);
+            }
+        }
+        return;
+    }
+
+    // Pool global, usado apenas quando há trabalho suficiente
+    ThreadPool& pool = ThreadPool::global();
+    const bool parallel = pool.size() > 1 && m * n * k >= GEMM_PARALLEL_MIN_WORK;
+
+    // Poucas linhas com B transposta: produtos escalares diretos sobre as linhas contíguas de B
+    // (em paralelo, cada tarefa fica com uma faixa de colunas de C, com pares inteiros no caso do SwiGLU)
+    if (transpose_b && m <= GEMM_DOT_ROWS) {
+        const std::size_t step = swiglu ? 2 : 1;
+        auto dots = [&](std::size_t u0, std::size_t u1) {
+            const std::size_t j0 = u0 * step;
+            const std::size_t j1 = u1 * step;
+            for (std::size_t j = j0; j < j1; ++j) {
+                for (std::size_t i = 0; i < m; ++i) {
+                    c(i, j) += alpha * kernel.dot(&a(i, 0), &b(j, 0), k);
+                }
+            }
+            if (epilogue.active()) {
+                for (std::size_t i = 0; i < m; ++i) {
+                    epilogue.apply(i, j0, &c(i, j0), j1 - j0);
+                }
+            }
+        };
+        if (parallel) {
+            pool.parallelFor(n / step, GEMM_DOT_GRAIN, dots);
+        } else {
+            dots(0, n / step);
+        }
+        return;
+    }
+
+    constexpr std::size_t GEMM_KC = GEMM_KC_BYTES / sizeof(T);
+    const std::size_t mr = kernel.mr;
+    const std::size_t nr = kernel.nr;
+    const std::size_t mc_block = std::max(mr, GEMM_MC / mr * mr);
+    const std::size_t nc_block = std::max(nr, GEMM_NC / nr * nr);
+
+    // Buffers de empacotamento por thread
+    thread_local std::vector<T, AlignedAllocator<T>> a_buffer, b_buffer;
+
+    // Calcula os blocos de registradores das linhas [ic, ic + mc) e dos painéis [panel0, panel1) do bloco jc,
+    // a partir do bloco de A empacotado em a_packed e do bloco de B empacotado em b_packed. No último bloco de k
+    // ('last'), cada bloco de C já está completo e recebe o epílogo enquanto ainda está no cache.
+    const bool fused = epilogue.active();
+    auto computeBlock = [&](const T* a_packed, std::size_t ic, std::size_t mc, const T* b_packed,
+                            std::size_t jc, std::size_t nc, std::size_t panel0, std::size_t panel1, std::size_t kc, bool last) {
+        for (std::size_t jr = panel0 * nr; jr < std::min(nc, panel1 * nr); jr += nr) {
+            const std::size_t cols = std::min(nr, nc - jr);
+            const T* b_panel = b_packed + (jr / nr) * nr * kc;
+
+            for (std::size_t ir = 0; ir < mc; ir += mr) {
+                const std::size_t rows = std::min(mr, mc - ir);
+                const T* a_panel = a_packed + (ir / mr) * mr * kc;
+                T* c_tile = &c(ic + ir, jc + jr);
+
+                if (rows == mr && cols == nr) {
+                    kernel.compute(kc, a_panel, b_panel, c_tile, c.stride());
+                } else {
+                    // Bloco de borda: calcula em um bloco temporário e soma só a parte válida
+                    alignas(TENSOR_ALIGNMENT) T tile[GEMM_MAX_TILE] = {};
+                    kernel.compute(kc, a_panel, b_panel, tile, nr);
+                    for (std::size_t i = 0; i < rows; ++i) {
+                        for (std::size_t j = 0; j < cols; ++j) {
+                            c_tile[i * c.stride() + j] += tile[i * nr + j];
+                        }
+                    }
+                }
+                if (last && fused) {
+                    for (std::size_t i = 0; i < rows; ++i) {
+                        epilogue.apply(ic + ir + i, jc + jr, c_tile + i * c.stride(), cols);
+                    }
+                }
+            }
+        }
+    };
+
+    // Caminho paralelo: para cada bloco (jc, pc), B é empacotado por faixas de painéis, todos os blocos de A são
+    // empacotados de uma vez e os blocos de C (bloco de linhas x grupo de painéis) são divididos entre as threads.
+    // Cada bloco de C é calculado pelas mesmas chamadas do caminho serial, então o resultado não muda.
+    if (parallel) {
+        thread_local std::vector<T, AlignedAllocator<T>> a_all_buffer;
+        const std::size_t m_blocks = (m + mc_block - 1) / mc_block;
+
+        for (std::size_t jc = 0; jc < n; jc += nc_block) {
+            const std::size_t nc = std::min(nc_block, n - jc);
+            const std::size_t panels = (nc + nr - 1) / nr;
+
+            // Grupos de painéis suficientes para ter cerca de 4 tarefas por thread
+            const std::size_t groups = std::min(panels, std::max<std::size_t>(1, (4 * pool.size() + m_blocks - 1) / m_blocks));
+            const std::size_t panels_per_group = (panels + groups - 1) / groups;
+
+            for (std::size_t pc = 0; pc < k; pc += GEMM_KC) {
+                const std::size_t kc = std::min(GEMM_KC, k - pc);
+
+                // Empacota o bloco kc x nc de op(B), uma faixa de painéis por tarefa
+                T* b_packed = packBuffer(b_buffer, kc * panels * nr);
+                pool.parallelFor(panels, 1, [&](std::size_t p0, std::size_t p1) {
+                    packB(b, transpose_b, pc, kc, jc + p0 * nr, std::min(nc, p1 * nr) - p0 * nr, nr, b_packed + p0 * nr * kc);
+                });
+
+                // Empacota todos os blocos mc x kc de A (cada um com mc_block linhas reservadas)
+                T* a_packed = packBuffer(a_all_buffer, m_blocks * mc_block * kc);
+                pool.parallelFor(m_blocks, [&](std::size_t block) {
+                    const std::size_t ic = block * mc_block;
+                    packA(a, ic, std::min(mc_block, m - ic), pc, kc, mr, alpha, a_packed + block * mc_block * kc);
+                });
+
+                // Calcula os blocos de C
+                pool.parallelFor(m_blocks * groups, [&](std::size_t task) {
+                    const std::size_t block = task / groups;
+                    const std::size_t group = task % groups;
+                    const std::size_t ic = block * mc_block;
+                    computeBlock(a_packed + block * mc_block * kc, ic, std::min(mc_block, m - ic), b_packed, jc, nc,
+                                 group * panels_per_group, std::min(panels, (group + 1) * panels_per_group), kc, pc + kc == k);
+                });
+            }
+        }
+        return;
+    }
+
+    for (std::size_t jc = 0; jc < n; jc += nc_block) {
+        const std::size_t nc = std::min(nc_block, n - jc);
+        const std::size_t nc_padded = (nc + nr - 1) / nr * nr;
+
+        for (std::size_t pc = 0; pc < k; pc += GEMM_KC) {
+            const std::size_t kc = std::min(GEMM_KC, k - pc);
+
+            // Empacota o bloco kc x nc de op(B)
+            T* b_packed = packBuffer(b_buffer, kc * nc_padded);
+            packB(b, transpose_b, pc, kc, jc, nc, nr, b_packed);
+
+            for (std::size_t ic = 0; ic < m; ic += mc_block) {
+                const std::size_t mc = std::min(mc_block, m - ic);
+                const std::size_t mc_padded = (mc + mr - 1) / mr * mr;
+
+                // Empacota o bloco mc x kc de A
+                T* a_packed = packBuffer(a_buffer, mc_padded * kc);
+                packA(a, ic, mc, pc, kc, mr, alpha, a_packed);
+
+                // Percorre os blocos de registradores MR x NR
+                computeBlock(a_packed, ic, mc, b_packed, jc, nc, 0, nc_padded / nr, kc, pc + kc == k);
+            }
+        }
+    }
+}
+
+// Função que calcula C = alpha * A * op(B) + beta * C em precisão simples
+void VectorMath::gemm(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c, bool transpose_b, float alpha, float beta) {
+    gemmDriver(gemmKernels().f32, a, b, c, transpose_b, alpha, beta, GemmEpilogue<float>{});
+}
+
+// Função que calcula C = alpha * A * op(B) + beta * C em precisão dupla
+void VectorMath::gemm(MatrixView<const double> a, MatrixView<const double> b, MatrixView<double> c, bool transpose_b, double alpha, double beta) {
+    gemmDriver(gemmKernels().f64, a, b, c, transpose_b, alpha, beta, GemmEpilogue<double>{});
+}
+
+// Função que calcula C = A * op(B) em precisão simples com o epílogo fundido
+void VectorMath::gemm(MatrixView<const float> a, MatrixView<const float> b, MatrixView<float> c, bool transpose_b, const GemmEpilogue<float>& epilogue) {
+    gemmDriver(gemmKernels().f32, a, b, c, transpose_b, 1.0f, 0.0f, epilogue);
+}
+
+// Função que calcula C = A * op(B) em precisão dupla com o epílogo fundido
+void VectorMath::gemm(MatrixView<const double> a, MatrixView<const double> b, MatrixView<double> c, bool transpose_b, const GemmEpilogue<double>& epilogue) {
+    gemmDriver(gemmKernels().f64, a, b, c, transpose_b, 1.0, 0.0, epilogue);
+}
+
+// Função que retorna o nome do conjunto de instruções usado pelo GEMM
+const char* VectorMath::gemmBackend() {
+    return gemmKernels().name;
+}
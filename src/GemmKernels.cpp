@@ -0,0 +1,183 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+// Micro-kernels de GEMM portáveis (C++ puro) e SSE2 (base de todo processador x86-64).
+
+// Inclui as declarações dos kernels de GEMM
+#include "../include/GemmKernels.hpp"
+
+// Inclui as intrínsecas SSE2 quando compilado para x86
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Micro-kernel escalar MR x NR: o compilador mantém o acumulador em registradores
+template <typename T, std::size_t MR, std::size_t NR>
+static void microScalar(std::size_t kc, const T* a, const T* b, T* c, std::size_t ldc) {
+    T acc[MR][NR] = {};
+    for (std::size_t p = 0; p < kc; ++p) {
+        for (std::size_t i = 0; i < MR; ++i) {
+            for (std::size_t j = 0; j < NR; ++j) {
+                acc[i][j] += a[p * MR + i] * b[p * NR + j];
+            }
+        }
+    }
+    for (std::size_t i = 0; i < MR; ++i) {
+        for (std::size_t j = 0; j < NR; ++j) {
+            c[i * ldc + j] += acc[i][j];
+        }
+    }
+}
+
+// Produto escalar com quatro acumuladores independentes (quebra a dependência entre somas)
+template <typename T>
+static T dotScalar(const T* x, const T* y, std::size_t n) {
+    T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 += x[i] * y[i];
+        s1 += x[i + 1] * y[i + 1];
+        s2 += x[i + 2] * y[i + 2];
+        s3 += x[i + 3] * y[i + 3];
+    }
+    for (; i < n; ++i) {
+        s0 += x[i] * y[i];
+    }
+    return (s0 + s1) + (s2 + s3);
+}
+
+// Kernels portáveis: usados fora de x86 ou quando forçados pela variável BUMBLEBEE_GEMM_ISA
+const GemmBackend* gemmBackendScalar() {
+    static const GemmBackend backend = [] {
+        GemmBackend b;
+        b.name = "scalar";
+        b.f32 = {4, 8, &microScalar<float, 4, 8>, &dotScalar<float>};
+        b.f64 = {4, 4, &microScalar<double, 4, 4>, &dotScalar<double>};
+        return b;
+    }();
+    return &backend;
+}
+
+// Produto escalar INT8 portável
+static int32_t dotInt8Scalar(const uint8_t* x, const int8_t* w, std::size_t n) {
+    int32_t sum = 0;
+    for (std::size_t p = 0; p < n; ++p) {
+        sum += static_cast<int32_t>(x[p]) * static_cast<int32_t>(w[p]);
+    }
+    return sum;
+}
+
+// Quatro produtos escalares INT8 portáveis
+static void dot4Int8Scalar(const uint8_t* x, const int8_t* w, std::size_t stride, std::size_t n, int32_t* out) {
+    for (std::size_t r = 0; r < 4; ++r) {
+        out[r] = dotInt8Scalar(x, w + r * stride, n);
+    }
+}
+
+// Kernels INT8 portáveis
+const Int8Backend* int8BackendScalar() {
+    static const Int8Backend backend = {"scalar", &dot4Int8Scalar, &dotInt8Scalar};
+    return &backend;
+}
+
+#if defined(__SSE2__)
+
+// Micro-kernel SSE2 4 x 4 em precisão dupla: cada linha de C ocupa dois registradores XMM
+static void microSSE2F64(std::size_t kc, const double* a, const double* b, double* c, std::size_t ldc) {
+    __m128d acc[4][2];
+    for (int i = 0; i < 4; ++i) {
+        acc[i][0] = _mm_setzero_pd();
+        acc[i][1] = _mm_setzero_pd();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m128d b0 = _mm_loadu_pd(b + p * 4);
+        __m128d b1 = _mm_loadu_pd(b + p * 4 + 2);
+        for (int i = 0; i < 4; ++i) {
+            __m128d ai = _mm_set1_pd(a[p * 4 + i]);
+            acc[i][0] = _mm_add_pd(acc[i][0], _mm_mul_pd(ai, b0));
+            acc[i][1] = _mm_add_pd(acc[i][1], _mm_mul_pd(ai, b1));
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        double* row = c + i * ldc;
+        _mm_storeu_pd(row, _mm_add_pd(_mm_loadu_pd(row), acc[i][0]));
+        _mm_storeu_pd(row + 2, _mm_add_pd(_mm_loadu_pd(row + 2), acc[i][1]));
+    }
+}
+
+// Produto escalar SSE2 em precisão dupla
+static double dotSSE2F64(const double* x, const double* y, std::size_t n) {
+    __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(x + i + 2), _mm_loadu_pd(y + i + 2)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, _mm_add_pd(s0, s1));
+    double sum = lanes[0] + lanes[1];
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+// Micro-kernel SSE2 4 x 8 em precisão simples: cada linha de C ocupa dois registradores XMM
+static void microSSE2F32(std::size_t kc, const float* a, const float* b, float* c, std::size_t ldc) {
+    __m128 acc[4][2];
+    for (int i = 0; i < 4; ++i) {
+        acc[i][0] = _mm_setzero_ps();
+        acc[i][1] = _mm_setzero_ps();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m128 b0 = _mm_loadu_ps(b + p * 8);
+        __m128 b1 = _mm_loadu_ps(b + p * 8 + 4);
+        for (int i = 0; i < 4; ++i) {
+            __m128 ai = _mm_set1_ps(a[p * 4 + i]);
+            acc[i][0] = _mm_add_ps(acc[i][0], _mm_mul_ps(ai, b0));
+            acc[i][1] = _mm_add_ps(acc[i][1], _mm_mul_ps(ai, b1));
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        float* row = c + i * ldc;
+        _mm_storeu_ps(row, _mm_add_ps(_mm_loadu_ps(row), acc[i][0]));
+        _mm_storeu_ps(row + 4, _mm_add_ps(_mm_loadu_ps(row + 4), acc[i][1]));
+    }
+}
+
+// Produto escalar SSE2 em precisão simples
+static float dotSSE2F32(const float* x, const float* y, std::size_t n) {
+    __m128 s0 = _mm_setzero_ps(), s1 = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+        s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(x + i + 4), _mm_loadu_ps(y + i + 4)));
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, _mm_add_ps(s0, s1));
+    float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+// Kernels SSE2
+const GemmBackend* gemmBackendSSE2() {
+    static const GemmBackend backend = [] {
+        GemmBackend b;
+        b.name = "sse2";
+        b.f32 = {4, 8, &microSSE2F32, &dotSSE2F32};
+        b.f64 = {4, 4, &microSSE2F64, &dotSSE2F64};
+        return b;
+    }();
+    return &backend;
+}
+
+#else
+
+// SSE2 indisponível nesta arquitetura
+const GemmBackend* gemmBackendSSE2() {
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,214 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+// Micro-kernels de GEMM com AVX2 + FMA. Apenas as funções entre push_options e pop_options
+// são compiladas para AVX2; elas só são chamadas depois que CpuFeatures confirma o suporte.
+
+// Inclui as declarações dos kernels de GEMM
+#include "../include/GemmKernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+// Inclui as intrínsecas AVX2/FMA
+#include <immintrin.h>
+
+// Micro-kernel AVX2 6 x 8 em precisão dupla: 12 acumuladores YMM, 2 registradores para B e 1 broadcast de A
+static void microAVX2F64(std::size_t kc, const double* a, const double* b, double* c, std::size_t ldc) {
+    __m256d acc[6][2];
+    for (int i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_setzero_pd();
+        acc[i][1] = _mm256_setzero_pd();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m256d b0 = _mm256_loadu_pd(b + p * 8);
+        __m256d b1 = _mm256_loadu_pd(b + p * 8 + 4);
+        for (int i = 0; i < 6; ++i) {
+            __m256d ai = _mm256_broadcast_sd(a + p * 6 + i);
+            acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        double* row = c + i * ldc;
+        _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), acc[i][0]));
+        _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), acc[i][1]));
+    }
+}
+
+// Produto escalar AVX2 em precisão dupla
+static double dotAVX2F64(const double* x, const double* y, std::size_t n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        s0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), s0);
+        s1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4), s1);
+    }
+    __m256d s = _mm256_add_pd(s0, s1);
+    __m128d h = _mm_add_pd(_mm256_castpd256_pd128(s), _mm256_extractf128_pd(s, 1));
+    double sum = _mm_cvtsd_f64(_mm_add_sd(h, _mm_unpackhi_pd(h, h)));
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+// Micro-kernel AVX2 6 x 16 em precisão simples: mesma organização de registradores, com 8 floats por YMM
+static void microAVX2F32(std::size_t kc, const float* a, const float* b, float* c, std::size_t ldc) {
+    __m256 acc[6][2];
+    for (int i = 0; i < 6; ++i) {
+        acc[i][0] = _mm256_setzero_ps();
+        acc[i][1] = _mm256_setzero_ps();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m256 b0 = _mm256_loadu_ps(b + p * 16);
+        __m256 b1 = _mm256_loadu_ps(b + p * 16 + 8);
+        for (int i = 0; i < 6; ++i) {
+            __m256 ai = _mm256_broadcast_ss(a + p * 6 + i);
+            acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+        }
+    }
+    for (int i = 0; i < 6; ++i) {
+        float* row = c + i * ldc;
+        _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), acc[i][0]));
+        _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), acc[i][1]));
+    }
+}
+
+// Produto escalar AVX2 em precisão simples
+static float dotAVX2F32(const float* x, const float* y, std::size_t n) {
+    __m256 s0 = _mm256_setzero_ps(), s1 = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), s0);
+        s1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8), _mm256_loadu_ps(y + i + 8), s1);
+    }
+    __m256 s = _mm256_add_ps(s0, s1);
+    __m128 h = _mm_add_ps(_mm256_castps256_ps128(s), _mm256_extractf128_ps(s, 1));
+    h = _mm_add_ps(h, _mm_movehl_ps(h, h));
+    float sum = _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+    for (; i < n; ++i) {
+        sum += x[i] * y[i];
+    }
+    return sum;
+}
+
+// Soma os 8 inteiros de um registrador YMM
+static inline int32_t reduceAddEpi32AVX2(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+// Produto de 16 pares u8 x s8 somados em 8 int32. Estende para 16 bits antes de multiplicar:
+// _mm256_maddubs_epi16 saturaria em 16 bits quando dois produtos grandes (até 255 * 127) se somam.
+static inline __m256i madd16Int8AVX2(__m256i x16, const int8_t* w) {
+    __m256i w16 = _mm256_cvtepi8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(w)));
+    return _mm256_madd_epi16(x16, w16);
+}
+
+// Quatro produtos escalares INT8 com AVX2
+static void dot4Int8AVX2(const uint8_t* x, const int8_t* w, std::size_t stride, std::size_t n, int32_t* out) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+    __m256i s2 = _mm256_setzero_si256(), s3 = _mm256_setzero_si256();
+    for (std::size_t p = 0; p < n; p += 16) {
+        __m256i x16 = _mm256_cvtepu8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(x + p)));
+        s0 = _mm256_add_epi32(s0, madd16Int8AVX2(x16, w + p));
+        s1 = _mm256_add_epi32(s1, madd16Int8AVX2(x16, w + stride + p));
+        s2 = _mm256_add_epi32(s2, madd16Int8AVX2(x16, w + 2 * stride + p));
+        s3 = _mm256_add_epi32(s3, madd16Int8AVX2(x16, w + 3 * stride + p));
+    }
+    out[0] = reduceAddEpi32AVX2(s0);
+    out[1] = reduceAddEpi32AVX2(s1);
+    out[2] = reduceAddEpi32AVX2(s2);
+    out[3] = reduceAddEpi32AVX2(s3);
+}
+
+// Produto escalar INT8 com AVX2
+static int32_t dotInt8AVX2(const uint8_t* x, const int8_t* w, std::size_t n) {
+    __m256i s = _mm256_setzero_si256();
+    for (std::size_t p = 0; p < n; p += 16) {
+        __m256i x16 = _mm256_cvtepu8_epi16(_mm_load_si128(reinterpret_cast<const __m128i*>(x + p)));
+        s = _mm256_add_epi32(s, madd16Int8AVX2(x16, w + p));
+    }
+    return reduceAddEpi32AVX2(s);
+}
+
+#pragma GCC pop_options
+
+// Inclui fma no alvo porque as intrínsecas já foram declaradas sob "avx2,fma" (senão o GCC recusa o inline)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma,avxvnni")
+
+// Quatro produtos escalares INT8 com AVX-VNNI: vpdpbusd multiplica 4 pares u8 x s8 e soma em cada int32, sem saturar
+static void dot4Int8AVXVNNI(const uint8_t* x, const int8_t* w, std::size_t stride, std::size_t n, int32_t* out) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = _mm256_setzero_si256();
+    __m256i s2 = _mm256_setzero_si256(), s3 = _mm256_setzero_si256();
+    for (std::size_t p = 0; p < n; p += 32) {
+        __m256i xv = _mm256_load_si256(reinterpret_cast<const __m256i*>(x + p));
+        s0 = _mm256_dpbusd_avx_epi32(s0, xv, _mm256_load_si256(reinterpret_cast<const __m256i*>(w + p)));
+        s1 = _mm256_dpbusd_avx_epi32(s1, xv, _mm256_load_si256(reinterpret_cast<const __m256i*>(w + stride + p)));
+        s2 = _mm256_dpbusd_avx_epi32(s2, xv, _mm256_load_si256(reinterpret_cast<const __m256i*>(w + 2 * stride + p)));
+        s3 = _mm256_dpbusd_avx_epi32(s3, xv, _mm256_load_si256(reinterpret_cast<const __m256i*>(w + 3 * stride + p)));
+    }
+    out[0] = reduceAddEpi32AVX2(s0);
+    out[1] = reduceAddEpi32AVX2(s1);
+    out[2] = reduceAddEpi32AVX2(s2);
+    out[3] = reduceAddEpi32AVX2(s3);
+}
+
+// Produto escalar INT8 com AVX-VNNI
+static int32_t dotInt8AVXVNNI(const uint8_t* x, const int8_t* w, std::size_t n) {
+    __m256i s = _mm256_setzero_si256();
+    for (std::size_t p = 0; p < n; p += 32) {
+        s = _mm256_dpbusd_avx_epi32(s, _mm256_load_si256(reinterpret_cast<const __m256i*>(x + p)),
+                                    _mm256_load_si256(reinterpret_cast<const __m256i*>(w + p)));
+    }
+    return reduceAddEpi32AVX2(s);
+}
+
+#pragma GCC pop_options
+
+// Kernels INT8 AVX2
+const Int8Backend* int8BackendAVX2() {
+    static const Int8Backend backend = {"avx2", &dot4Int8AVX2, &dotInt8AVX2};
+    return &backend;
+}
+
+// Kernels INT8 AVX-VNNI
+const Int8Backend* int8BackendAVXVNNI() {
+    static const Int8Backend backend = {"avxvnni", &dot4Int8AVXVNNI, &dotInt8AVXVNNI};
+    return &backend;
+}
+
+// Kernels AVX2
+const GemmBackend* gemmBackendAVX2() {
+    static const GemmBackend backend = [] {
+        GemmBackend b;
+        b.name = "avx2";
+        b.f32 = {6, 16, &microAVX2F32, &dotAVX2F32};
+        b.f64 = {6, 8, &microAVX2F64, &dotAVX2F64};
+        return b;
+    }();
+    return &backend;
+}
+
+#else
+
+// AVX2 indisponível nesta arquitetura ou compilador
+const GemmBackend* gemmBackendAVX2() {
+    return nullptr;
+}
+
+const Int8Backend* int8BackendAVX2() {
+    return nullptr;
+}
+
+const Int8Backend* int8BackendAVXVNNI() {
+    return nullptr;
+}
+
+#endif
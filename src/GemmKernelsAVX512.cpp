@@ -0,0 +1,182 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+// Micro-kernels de GEMM com AVX-512F. Apenas as funções entre push_options e pop_options
+// são compiladas para AVX-512; elas só são chamadas depois que CpuFeatures confirma o suporte.
+
+// Inclui as declarações dos kernels de GEMM
+#include "../include/GemmKernels.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+// Inclui as intrínsecas AVX-512
+#include <immintrin.h>
+
+// Micro-kernel AVX-512 8 x 24 em precisão dupla: 24 acumuladores ZMM, 3 registradores para B e 1 broadcast de A
+static void microAVX512F64(std::size_t kc, const double* a, const double* b, double* c, std::size_t ldc) {
+    __m512d acc[8][3];
+    for (int i = 0; i < 8; ++i) {
+        acc[i][0] = _mm512_setzero_pd();
+        acc[i][1] = _mm512_setzero_pd();
+        acc[i][2] = _mm512_setzero_pd();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m512d b0 = _mm512_loadu_pd(b + p * 24);
+        __m512d b1 = _mm512_loadu_pd(b + p * 24 + 8);
+        __m512d b2 = _mm512_loadu_pd(b + p * 24 + 16);
+        for (int i = 0; i < 8; ++i) {
+            __m512d ai = _mm512_set1_pd(a[p * 8 + i]);
+            acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+            acc[i][2] = _mm512_fmadd_pd(ai, b2, acc[i][2]);
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        double* row = c + i * ldc;
+        _mm512_storeu_pd(row, _mm512_add_pd(_mm512_loadu_pd(row), acc[i][0]));
+        _mm512_storeu_pd(row + 8, _mm512_add_pd(_mm512_loadu_pd(row + 8), acc[i][1]));
+        _mm512_storeu_pd(row + 16, _mm512_add_pd(_mm512_loadu_pd(row + 16), acc[i][2]));
+    }
+}
+
+// Produto escalar AVX-512 em precisão dupla (a cauda usa máscara em vez de laço escalar)
+static double dotAVX512F64(const double* x, const double* y, std::size_t n) {
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        s0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), s0);
+        s1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8), _mm512_loadu_pd(y + i + 8), s1);
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = (n - i >= 8) ? static_cast<__mmask8>(0xFF) : static_cast<__mmask8>((1u << (n - i)) - 1);
+        s0 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i), s0);
+    }
+    alignas(64) double lanes[8];
+    _mm512_store_pd(lanes, _mm512_add_pd(s0, s1));
+    return ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+}
+
+// Micro-kernel AVX-512 8 x 48 em precisão simples: mesma organização de registradores, com 16 floats por ZMM
+static void microAVX512F32(std::size_t kc, const float* a, const float* b, float* c, std::size_t ldc) {
+    __m512 acc[8][3];
+    for (int i = 0; i < 8; ++i) {
+        acc[i][0] = _mm512_setzero_ps();
+        acc[i][1] = _mm512_setzero_ps();
+        acc[i][2] = _mm512_setzero_ps();
+    }
+    for (std::size_t p = 0; p < kc; ++p) {
+        __m512 b0 = _mm512_loadu_ps(b + p * 48);
+        __m512 b1 = _mm512_loadu_ps(b + p * 48 + 16);
+        __m512 b2 = _mm512_loadu_ps(b + p * 48 + 32);
+        for (int i = 0; i < 8; ++i) {
+            __m512 ai = _mm512_set1_ps(a[p * 8 + i]);
+            acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+            acc[i][2] = _mm512_fmadd_ps(ai, b2, acc[i][2]);
+        }
+    }
+    for (int i = 0; i < 8; ++i) {
+        float* row = c + i * ldc;
+        _mm512_storeu_ps(row, _mm512_add_ps(_mm512_loadu_ps(row), acc[i][0]));
+        _mm512_storeu_ps(row + 16, _mm512_add_ps(_mm512_loadu_ps(row + 16), acc[i][1]));
+        _mm512_storeu_ps(row + 32, _mm512_add_ps(_mm512_loadu_ps(row + 32), acc[i][2]));
+    }
+}
+
+// Produto escalar AVX-512 em precisão simples (a cauda usa máscara em vez de laço escalar)
+static float dotAVX512F32(const float* x, const float* y, std::size_t n) {
+    __m512 s0 = _mm512_setzero_ps(), s1 = _mm512_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        s0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), s0);
+        s1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16), _mm512_loadu_ps(y + i + 16), s1);
+    }
+    for (; i < n; i += 16) {
+        __mmask16 mask = (n - i >= 16) ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << (n - i)) - 1);
+        s0 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i), s0);
+    }
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, _mm512_add_ps(s0, s1));
+    float sum = 0.0f;
+    for (int l = 0; l < 16; ++l) {
+        sum += lanes[l];
+    }
+    return sum;
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512vnni")
+
+// Soma os 16 inteiros de um registrador ZMM
+static inline int32_t reduceAddEpi32AVX512(__m512i v) {
+    alignas(64) int32_t lanes[16];
+    _mm512_store_si512(lanes, v);
+    int32_t sum = 0;
+    for (int l = 0; l < 16; ++l) {
+        sum += lanes[l];
+    }
+    return sum;
+}
+
+// Quatro produtos escalares INT8 com AVX-512 VNNI: cada vpdpbusd processa 64 pares u8 x s8
+static void dot4Int8AVX512VNNI(const uint8_t* x, const int8_t* w, std::size_t stride, std::size_t n, int32_t* out) {
+    __m512i s0 = _mm512_setzero_si512(), s1 = _mm512_setzero_si512();
+    __m512i s2 = _mm512_setzero_si512(), s3 = _mm512_setzero_si512();
+    for (std::size_t p = 0; p < n; p += 64) {
+        __m512i xv = _mm512_load_si512(x + p);
+        s0 = _mm512_dpbusd_epi32(s0, xv, _mm512_load_si512(w + p));
+        s1 = _mm512_dpbusd_epi32(s1, xv, _mm512_load_si512(w + stride + p));
+        s2 = _mm512_dpbusd_epi32(s2, xv, _mm512_load_si512(w + 2 * stride + p));
+        s3 = _mm512_dpbusd_epi32(s3, xv, _mm512_load_si512(w + 3 * stride + p));
+    }
+    out[0] = reduceAddEpi32AVX512(s0);
+    out[1] = reduceAddEpi32AVX512(s1);
+    out[2] = reduceAddEpi32AVX512(s2);
+    out[3] = reduceAddEpi32AVX512(s3);
+}
+
+// Produto escalar INT8 com AVX-512 VNNI
+static int32_t dotInt8AVX512VNNI(const uint8_t* x, const int8_t* w, std::size_t n) {
+    __m512i s = _mm512_setzero_si512();
+    for (std::size_t p = 0; p < n; p += 64) {
+        s = _mm512_dpbusd_epi32(s, _mm512_load_si512(x + p), _mm512_load_si512(w + p));
+    }
+    return reduceAddEpi32AVX512(s);
+}
+
+#pragma GCC pop_options
+
+// Kernels INT8 AVX-512 VNNI
+const Int8Backend* int8BackendAVX512VNNI() {
+    static const Int8Backend backend = {"avx512vnni", &dot4Int8AVX512VNNI, &dotInt8AVX512VNNI};
+    return &backend;
+}
+
+// Kernels AVX-512
+const GemmBackend* gemmBackendAVX512() {
+    static const GemmBackend backend = [] {
+        GemmBackend b;
+        b.name = "avx512";
+        b.f32 = {8, 48, &microAVX512F32, &dotAVX512F32};
+        b.f64 = {8, 24, &microAVX512F64, &dotAVX512F64};
+        return b;
+    }();
+    return &backend;
+}
+
+#else
+
+// AVX-512 indisponível nesta arquitetura ou compilador
+const GemmBackend* gemmBackendAVX512() {
+    return nullptr;
+}
+
+const Int8Backend* int8BackendAVX512VNNI() {
+    return nullptr;
+}
+
+#endif
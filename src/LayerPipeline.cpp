@@ -0,0 +1,190 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe LayerPipeline é definida
+#include "../include/LayerPipeline.hpp"
+
+// Inclui std::max e std::clamp
+#include <algorithm>
+
+// Custo relativo de cada camada na divisão entre os estágios: a camada do decoder tem duas atenções e a do encoder
+// uma (ambas com a feedforward), e a camada final é uma única projeção
+static constexpr std::size_t ENCODER_LAYER_COST = 2;
+static constexpr std::size_t DECODER_LAYER_COST = 3;
+static constexpr std::size_t FINAL_LAYER_COST = 1;
+
+// Construtor que monta as camadas, divide-as entre os estágios e inicia as threads
+LayerPipeline::LayerPipeline(Source source, Encoder& encoder, Decoder& decoder, const FinalLayer& finalLayer,
+                             std::size_t num_stages, std::size_t queue_capacity)
+    : source(std::move(source)) {
+
+    // Lista das camadas na ordem do forward, com o custo de cada uma
+    std::vector<Unit> units;
+    std::vector<std::size_t> costs;
+    const std::size_t encoder_layers = encoder.numLayers();
+    const std::size_t decoder_layers = decoder.numLayers();
+
+    // Encoder: a primeira camada lê o lote de entrada e a última guarda a saída para a cross-attention
+    for (std::size_t i = 0; i < encoder_layers; ++i) {
+        units.push_back([&encoder, i, encoder_layers](PipelineBatch& batch) {
+            batch.hidden = encoder.forwardLayer(i, i == 0 ? batch.input : batch.hidden, batch.layout);
+            if (i + 1 == encoder_layers) {
+                batch.encoder_output = std::move(batch.hidden);
+            }
+        });
+        costs.push_back(ENCODER_LAYER_COST);
+    }
+    if (encoder_layers == 0) {
+        units.push_back([](PipelineBatch& batch) { batch.encoder_output = batch.input; });
+        costs.push_back(0);
+    }
+
+    // Decoder: a primeira camada também lê o lote de entrada
+    for (std::size_t i = 0; i < decoder_layers; ++i) {
+        units.push_back([&decoder, i](PipelineBatch& batch) {
+            batch.hidden = decoder.forwardLayer(i, i == 0 ? batch.input : batch.hidden, batch.layout,
+                                                batch.encoder_output, batch.layout);
+        });
+        costs.push_back(DECODER_LAYER_COST);
+    }
+
+    // Camada final
+    units.push_back([&finalLayer, decoder_layers](PipelineBatch& batch) {
+        batch.probabilities = finalLayer.forward(decoder_layers == 0 ? batch.input : batch.hidden);
+    });
+    costs.push_back(FINAL_LAYER_COST);
+
+    // Divide as camadas em grupos contíguos: cada estágio recebe as camadas cujo ponto médio ainda cabe na sua parte
+    // do custo restante (custo restante / estágios restantes), com ao menos uma camada por estágio
+    num_stages = std::clamp<std::size_t>(num_stages, 1, units.size());
+    std::size_t remaining_cost = 0;
+    for (std::size_t cost : costs) {
+        remaining_cost += cost;
+    }
+    std::size_t u = 0;
+    for (std::size_t s = 0; s < num_stages; ++s) {
+        const std::size_t stages_left = num_stages - s;
+        std::vector<Unit> group;
+        std::size_t cost = 0;
+        while (u < units.size() && units.size() - u > stages_left - 1 &&
+               (group.empty() || (2 * cost + costs[u]) * stages_left <= 2 * remaining_cost)) {
+            cost += costs[u];
+            group.push_back(std::move(units[u]));
+            ++u;
+        }
+        if (s + 1 == num_stages) {
+            for (; u < units.size(); ++u) {
+                group.push_back(std::move(units[u]));
+            }
+        }
+        remaining_cost -= cost;
+        stages.push_back(std::move(group));
+    }
+
+    // Filas entre a entrada, os estágios e next()
+    for (std::size_t s = 0; s <= stages.size(); ++s) {
+        links.push_back(std::make_unique<Link>(std::max<std::size_t>(queue_capacity, 1)));
+    }
+
+    // Threads de entrada e dos estágios
+    threads.emplace_back(&LayerPipeline::sourceLoop, this);
+    for (std::size_t s = 0; s < stages.size(); ++s) {
+        threads.emplace_back(&LayerPipeline::stageLoop, this, s);
+    }
+}
+
+// Destrutor que interrompe o pipeline e encerra as threads
+LayerPipeline::~LayerPipeline() {
+
+    // A entrada para de produzir e os lotes que já estão no pipeline são descartados até a marca de fim
+    stopping = true;
+    while (!finished) {
+        if (!links.back()->pop()) {
+            finished = true;
+        }
+    }
+    join();
+}
+
+// Função que retorna o próximo lote processado
+std::unique_ptr<PipelineBatch> LayerPipeline::next() {
+    if (finished) {
+        return nullptr;
+    }
+    std::unique_ptr<PipelineBatch> batch = links.back()->pop();
+    if (!batch) {
+        finished = true;
+        join();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return batch;
+}
+
+// Função que retorna o número de estágios
+std::size_t LayerPipeline::numStages() const {
+    return stages.size();
+}
+
+// Laço da thread de entrada: chama 'source' até os lotes acabarem (ou o pipeline ser interrompido)
+void LayerPipeline::sourceLoop() {
+    while (!stopping) {
+        std::unique_ptr<PipelineBatch> batch;
+        try {
+            batch = source();
+        } catch (...) {
+            fail(std::current_exception());
+            break;
+        }
+        if (!batch) {
+            break;
+        }
+        links.front()->push(std::move(batch));
+    }
+    links.front()->push(nullptr);
+}
+
+// Laço da thread de um estágio: aplica as suas camadas a cada lote e o repassa ao estágio seguinte
+void LayerPipeline::stageLoop(std::size_t stage) {
+    Link& input = *links[stage];
+    Link& output = *links[stage + 1];
+    bool failed = false;
+    while (std::unique_ptr<PipelineBatch> batch = input.pop()) {
+
+        // Depois de uma exceção, o estágio só descarta os lotes que ainda chegarem, para não travar os anteriores
+        if (failed) {
+            continue;
+        }
+        try {
+            for (const Unit& unit : stages[stage]) {
+                unit(*batch);
+            }
+            output.push(std::move(batch));
+        } catch (...) {
+            fail(std::current_exception());
+            failed = true;
+        }
+    }
+    output.push(nullptr);
+}
+
+// Função que guarda a primeira exceção e interrompe a entrada de lotes
+void LayerPipeline::fail(std::exception_ptr exception) {
+    {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        if (!error) {
+            error = exception;
+        }
+    }
+    stopping = true;
+}
+
+// Função que espera todas as threads terminarem
+void LayerPipeline::join() {
+    for (std::thread& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
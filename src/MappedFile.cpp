@@ -0,0 +1,51 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe MappedFile é definida
+#include "../include/MappedFile.hpp"
+
+// Inclui exceções padrão
+#include <stdexcept>
+
+// Inclui as chamadas POSIX de arquivos e de mapeamento de memória
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Função que mapeia um arquivo inteiro em memória
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("MappedFile: não foi possível abrir " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("MappedFile: não foi possível ler o tamanho de " + path);
+    }
+    std::size_t length = static_cast<std::size_t>(info.st_size);
+
+    // Arquivos vazios não podem ser mapeados; o chamador recebe um mapeamento de tamanho zero
+    char* address = nullptr;
+    if (length > 0) {
+        void* mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("MappedFile: falha no mmap de " + path);
+        }
+        address = static_cast<char*>(mapped);
+    }
+
+    // O mapeamento continua válido depois que o descritor é fechado
+    ::close(fd);
+    return std::shared_ptr<MappedFile>(new MappedFile(address, length));
+}
+
+// Destrutor que desfaz o mapeamento
+MappedFile::~MappedFile() {
+    if (address != nullptr) {
+        ::munmap(address, length);
+    }
+}
@@ -0,0 +1,211 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+// Quantização INT8 por canal de saída e o GEMM INT8 usado na inferência quantizada.
+
+// Inclui o arquivo de cabeçalho onde a classe VectorMath é definida
+#include "../include/VectorOp.hpp"
+
+// Inclui as declarações dos kernels INT8
+#include "../include/GemmKernels.hpp"
+
+// Inclui a detecção de extensões do processador
+#include "../include/CpuFeatures.hpp"
+
+// Inclui std::getenv
+#include <cstdlib>
+
+// Inclui std::strcmp
+#include <cstring>
+
+// Inclui o pool de threads que divide as linhas de A entre os núcleos
+#include "../include/ThreadPool.hpp"
+
+// Maior valor absoluto de um peso ou ativação quantizado (simétrico: -127..127)
+static constexpr float INT8_MAX_LEVEL = 127.0f;
+
+// Ponto zero das ativações sem sinal: x_u8 = round(x / escala) + 128
+static constexpr int32_t INT8_ACTIVATION_ZERO_POINT = 128;
+
+// Multiplicações mínimas (linhas x canais de saída x colunas) por tarefa do GEMM INT8 paralelo
+static constexpr std::size_t INT8_PARALLEL_MIN_WORK = std::size_t(1) << 17;
+
+// Quantiza uma matriz com uma escala por linha (canal de saída)
+QuantizedMatrix QuantizedMatrix::quantize(MatrixView<const real_t> matrix) {
+    QuantizedMatrix q;
+    q.rows = matrix.rows();
+    q.cols = matrix.cols();
+    q.stride = (q.cols + INT8_COLUMN_ALIGNMENT - 1) / INT8_COLUMN_ALIGNMENT * INT8_COLUMN_ALIGNMENT;
+    q.weights.assign(q.rows * q.stride, 0);
+    q.scales.resize(q.rows);
+    q.row_sums.resize(q.rows);
+
+    for (std::size_t i = 0; i < q.rows; ++i) {
+        std::span<const real_t> values = matrix.row(i);
+
+        // A escala leva o maior valor absoluto da linha para 127 (linhas nulas ficam com escala 0)
+        real_t max_abs = 0;
+        for (real_t value : values) {
+            max_abs = std::max(max_abs, std::abs(value));
+        }
+        const float scale = static_cast<float>(max_abs) / INT8_MAX_LEVEL;
+        const float inverse = scale > 0.0f ? 1.0f / scale : 0.0f;
+
+        int8_t* row = q.weights.data() + i * q.stride;
+        int32_t sum = 0;
+        for (std::size_t j = 0; j < q.cols; ++j) {
+            float level = std::nearbyint(static_cast<float>(values[j]) * inverse);
+            row[j] = static_cast<int8_t>(std::clamp(level, -INT8_MAX_LEVEL, INT8_MAX_LEVEL));
+            sum += row[j];
+        }
+        q.scales[i] = scale;
+        q.row_sums[i] = sum;
+    }
+    return q;
+}
+
+// Reconstrói a matriz em ponto flutuante
+Tensor QuantizedMatrix::dequantize() const {
+    Tensor matrix(rows, cols);
+    for (std::size_t i = 0; i < rows; ++i) {
+        const int8_t* values = row(i);
+        for (std::size_t j = 0; j < cols; ++j) {
+            matrix(i, j) = static_cast<real_t>(scales[i] * values[j]);
+        }
+    }
+    return matrix;
+}
+
+// Escolhe o melhor conjunto de kernels INT8 suportado pelo processador (ou o forçado por BUMBLEBEE_INT8_ISA)
+static const Int8Backend* selectInt8Backend() {
+    const CpuFeatures& cpu = CpuFeatures::get();
+
+    // Candidatos em ordem de preferência, cada um com a condição de suporte
+    struct Candidate { const Int8Backend* backend; bool supported; };
+    const Candidate candidates[] = {
+        {int8BackendAVX512VNNI(), cpu.avx512f && cpu.avx512bw && cpu.avx512vnni},
+        {int8BackendAVXVNNI(), cpu.avx2 && cpu.avxvnni},
+        {int8BackendAVX2(), cpu.avx2},
+        {int8BackendScalar(), true},
+    };
+
+    // Permite forçar uma ISA (útil para comparar kernels e para depuração)
+    const char* forced = std::getenv("BUMBLEBEE_INT8_ISA");
+    if (forced != nullptr && *forced != '\0') {
+        for (const Candidate& candidate : candidates) {
+            if (candidate.backend != nullptr && std::strcmp(candidate.backend->name, forced) == 0) {
+                if (candidate.supported) {
+                    return candidate.backend;
+                }
+                break;
+            }
+        }
+        std::cerr << "BUMBLEBEE_INT8_ISA=" << forced << " indisponivel; usando a deteccao automatica." << std::endl;
+    }
+
+    for (const Candidate& candidate : candidates) {
+        if (candidate.backend != nullptr && candidate.supported) {
+            return candidate.backend;
+        }
+    }
+    return int8BackendScalar();
+}
+
+// Retorna o conjunto de kernels INT8 escolhido (decidido uma única vez)
+static const Int8Backend& int8Kernels() {
+    static const Int8Backend* backend = selectInt8Backend();
+    return *backend;
+}
+
+// Função que calcula C = A * W^T com W quantizada em INT8
+void VectorMath::gemmInt8(ConstTensorView a, const QuantizedMatrix& w, TensorView c, const GemmEpilogue<real_t>& epilogue,
+                          std::size_t first_row) {
+    if (a.cols() != w.cols || c.rows() != a.rows() || first_row > w.rows || c.cols() > w.rows - first_row) {
+        throw std::invalid_argument("VectorMath::gemmInt8: dimensões incompatíveis entre A, W e C.");
+    }
+    const bool swiglu = epilogue.activation == ActivationFunction::SwiGLU;
+    const std::size_t result_cols = swiglu ? c.cols() / 2 : c.cols();
+    if ((swiglu && (c.cols() % 2 != 0 || epilogue.gated.rows() != c.rows() || epilogue.gated.cols() != result_cols)) ||
+        (!epilogue.residual.empty() && (epilogue.residual.rows() != c.rows() || epilogue.residual.cols() != result_cols))) {
+        throw std::invalid_argument("VectorMath::gemmInt8: dimensões incompatíveis entre C e o epílogo.");
+    }
+    const bool fused = epilogue.active();
+    const Int8Backend& kernels = int8Kernels();
+
+    // Cada faixa de linhas de A é independente: as faixas são divididas entre as threads do pool global, com
+    // faixas grandes o bastante para valer o despacho (linhas x canais de saída x colunas >= INT8_PARALLEL_MIN_WORK)
+    const std::size_t channels = c.cols();
+    const std::size_t grain = std::max<std::size_t>(1, INT8_PARALLEL_MIN_WORK / std::max<std::size_t>(1, channels * w.stride));
+    ThreadPool::global().parallelFor(a.rows(), grain, [&](std::size_t row_begin, std::size_t row_end) {
+
+        // Linha de A quantizada, com o mesmo passo alinhado de W (as colunas extras multiplicam pesos zero)
+        thread_local std::vector<uint8_t, AlignedAllocator<uint8_t>> activations;
+        if (activations.size() < w.stride) {
+            activations.resize(w.stride);
+        }
+        uint8_t* x = activations.data();
+
+        for (std::size_t i = row_begin; i < row_end; ++i) {
+            std::span<const real_t> input = a.row(i);
+            std::span<real_t> output = c.row(i);
+
+            // Escala dinâmica da linha: o maior valor absoluto vira 127
+            real_t max_abs = 0;
+            for (real_t value : input) {
+                max_abs = std::max(max_abs, std::abs(value));
+            }
+            if (max_abs == 0) {
+                std::fill(output.begin(), output.end(), real_t(0));
+                if (fused) {
+                    epilogue.apply(i, 0, output.data(), output.size());
+                }
+                continue;
+            }
+            const float input_scale = static_cast<float>(max_abs) / INT8_MAX_LEVEL;
+            const float inverse = INT8_MAX_LEVEL / static_cast<float>(max_abs);
+            for (std::size_t p = 0; p < input.size(); ++p) {
+                float level = std::clamp(std::nearbyint(static_cast<float>(input[p]) * inverse), -INT8_MAX_LEVEL, INT8_MAX_LEVEL);
+                x[p] = static_cast<uint8_t>(static_cast<int32_t>(level) + INT8_ACTIVATION_ZERO_POINT);
+            }
+            std::fill(x + input.size(), x + w.stride, static_cast<uint8_t>(INT8_ACTIVATION_ZERO_POINT));
+
+            // soma(x_u8 * w) = soma(x_q * w) + 128 * soma(w): a soma de cada linha de W desconta o ponto zero
+            auto store = [&](std::size_t j, int32_t acc) {
+                int32_t exact = acc - INT8_ACTIVATION_ZERO_POINT * w.row_sums[first_row + j];
+                output[j] = static_cast<real_t>(input_scale * w.scales[first_row + j] * static_cast<float>(exact));
+            };
+
+            // Quatro canais de saída por chamada, reaproveitando cada carga da linha de A
+            std::size_t j = 0;
+            for (; j + 4 <= channels; j += 4) {
+                int32_t acc[4];
+                kernels.dot4(x, w.row(first_row + j), w.stride, w.stride, acc);
+                for (std::size_t r = 0; r < 4; ++r) {
+                    store(j + r, acc[r]);
+                }
+            }
+            for (; j < channels; ++j) {
+                store(j, kernels.dot(x, w.row(first_row + j), w.stride));
+            }
+
+            // Epílogo sobre a linha recém-calculada, ainda no cache
+            if (fused) {
+                epilogue.apply(i, 0, output.data(), output.size());
+            }
+        }
+    });
+}
+
+// Função que retorna o nome do conjunto de instruções usado pelo GEMM INT8
+const char* VectorMath::gemmInt8Backend() {
+    return int8Kernels().name;
+}
+
+// Função que aplica uma projeção linear com a versão INT8 dos pesos quando existir
+void VectorMath::project(ConstTensorView input, ConstTensorView weights, const QuantizedMatrix& quantized, TensorView output,
+                         const GemmEpilogue<real_t>& epilogue) {
+    if (!quantized.empty()) {
+        gemmInt8(input, quantized, output, epilogue);
+    } else {
+        gemm(input, weights, output, true, epilogue);
+    }
+}
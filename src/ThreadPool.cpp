@@ -0,0 +1,262 @@
+// Construindo Um LLM a Partir do Zero com Arquitetura Transformers em C++
+
+
+// Inclui o arquivo de cabeçalho onde a classe ThreadPool é definida
+#include "../include/ThreadPool.hpp"
+
+// Inclui contadores atômicos
+#include <atomic>
+
+// Inclui std::getenv e std::atoi
+#include <cstdlib>
+
+// Inclui std::min e std::max
+#include <algorithm>
+
+// Inclui std::exception_ptr, usado para repassar exceções das tarefas
+#include <exception>
+
+// Inclui as exceções padrão
+#include <stdexcept>
+
+// Inclui std::optional
+#include <optional>
+
+// Inclui a API de afinidade de threads (apenas no Linux)
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Configuração do pool global definida por configureGlobal, e se ele já foi criado
+static std::mutex global_config_mutex;
+static std::optional<std::pair<std::size_t, bool>> global_config;
+static bool global_created = false;
+
+// Chamadas de parallelFor simultâneas previstas (o vetor de chamadas só cresce se houver mais que isso)
+static constexpr std::size_t THREAD_POOL_RESERVED_JOBS = 64;
+
+// Estado de um parallelFor, na pilha da thread chamadora: função, índice do próximo item, trabalhadoras que estão
+// processando itens (workers, protegido pelo mutex do pool) e a primeira exceção
+struct ParallelForJob {
+    ParallelForJob(std::size_t count, FunctionRef<void(std::size_t)> fn) : count(count), fn(fn) {}
+
+    std::size_t count;
+    FunctionRef<void(std::size_t)> fn;
+    std::atomic<std::size_t> next{0};
+    std::size_t workers = 0;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    // Indica se ainda há índices a distribuir
+    bool pending() const { return next.load(std::memory_order_relaxed) < count; }
+
+    // Processa índices até acabarem
+    void run() {
+        for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+};
+
+// Função que prende uma thread ao núcleo 'cpu'
+static void pinThread(std::thread& thread, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+// Função que lista os núcleos que o processo pode usar (respeitando taskset/cgroups)
+static std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+// Construtor que cria as threads de trabalho
+ThreadPool::ThreadPool(std::size_t num_threads, bool pin_threads) {
+
+    // Usa o número de núcleos quando nenhum valor é informado
+    if (num_threads == 0) {
+        num_threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    // A thread chamadora também trabalha, então são criadas num_threads - 1 trabalhadoras. Com afinidade, a
+    // trabalhadora i fica no i-ésimo núcleo permitido; a chamadora não é presa (o núcleo 0 da lista fica para ela),
+    // para não restringir as outras threads que ela vier a criar.
+    const std::vector<int> cpus = pin_threads ? allowedCpus() : std::vector<int>();
+    jobs.reserve(THREAD_POOL_RESERVED_JOBS);
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+        if (!cpus.empty()) {
+            pinThread(workers.back(), cpus[i % cpus.size()]);
+        }
+    }
+}
+
+// Destrutor que encerra as threads de trabalho
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    task_available.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Função que retorna uma chamada em andamento com índices ainda não distribuídos
+ParallelForJob* ThreadPool::findJob() const {
+    for (ParallelForJob* job : jobs) {
+        if (job->pending()) {
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+// Laço principal de cada thread de trabalho: ajuda nas chamadas de parallelFor até o pool ser encerrado
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        ParallelForJob* job = nullptr;
+        task_available.wait(lock, [&] { return stopping || (job = findJob()) != nullptr; });
+        if (job == nullptr) {
+            return;
+        }
+
+        // Entra na chamada (a chamadora só retorna depois que todas as trabalhadoras saírem) e processa índices
+        ++job->workers;
+        lock.unlock();
+        job->run();
+        lock.lock();
+        if (--job->workers == 0) {
+            job_finished.notify_all();
+        }
+    }
+}
+
+// Executa fn(i) para cada i em [0, count) e espera todos terminarem
+void ThreadPool::parallelFor(std::size_t count, FunctionRef<void(std::size_t)> fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // Sem trabalhadoras ou com um único item, executa direto na thread chamadora (com a mesma regra de exceções)
+    if (workers.empty() || count == 1) {
+        std::exception_ptr error;
+        for (std::size_t i = 0; i < count; ++i) {
+            try {
+                fn(i);
+            } catch (...) {
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    // Publica a chamada para as trabalhadoras
+    ParallelForJob job(count, fn);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(&job);
+    }
+    if (count - 1 < workers.size()) {
+        for (std::size_t i = 0; i < count - 1; ++i) {
+            task_available.notify_one();
+        }
+    } else {
+        task_available.notify_all();
+    }
+
+    // A thread chamadora também processa índices
+    job.run();
+
+    // Retira a chamada (nenhuma trabalhadora entra depois disso) e espera as que estão processando itens dela
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobs.erase(std::find(jobs.begin(), jobs.end(), &job));
+        job_finished.wait(lock, [&job] { return job.workers == 0; });
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+
+// Executa fn(begin, end) para faixas contíguas de [0, count)
+void ThreadPool::parallelFor(std::size_t count, std::size_t grain, FunctionRef<void(std::size_t, std::size_t)> fn) {
+    if (count == 0) {
+        return;
+    }
+
+    // Até 4 faixas por thread equilibram a carga sem multiplicar o custo de despacho
+    const std::size_t max_chunks = (count + std::max<std::size_t>(grain, 1) - 1) / std::max<std::size_t>(grain, 1);
+    const std::size_t chunks = std::min(max_chunks, 4 * size());
+    if (chunks <= 1) {
+        fn(0, count);
+        return;
+    }
+    const std::size_t chunk = (count + chunks - 1) / chunks;
+    parallelFor((count + chunk - 1) / chunk, [&](std::size_t c) {
+        fn(c * chunk, std::min(count, (c + 1) * chunk));
+    });
+}
+
+// Número de threads que participam de um parallelFor
+std::size_t ThreadPool::size() const {
+    return workers.size() + 1;
+}
+
+// Pool compartilhado pelo processo inteiro
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool = [] {
+        std::lock_guard<std::mutex> lock(global_config_mutex);
+        global_created = true;
+        if (global_config) {
+            return ThreadPool(global_config->first, global_config->second);
+        }
+        const char* threads = std::getenv("BUMBLEBEE_NUM_THREADS");
+        const char* pin = std::getenv("BUMBLEBEE_PIN_THREADS");
+        return ThreadPool(threads != nullptr ? static_cast<std::size_t>(std::max(0, std::atoi(threads))) : std::size_t(0),
+                          pin != nullptr && std::atoi(pin) != 0);
+    }();
+    return pool;
+}
+
+// Função que configura o pool global antes do primeiro uso
+void ThreadPool::configureGlobal(std::size_t num_threads, bool pin_threads) {
+    std::lock_guard<std::mutex> lock(global_config_mutex);
+    if (global_created) {
+        throw std::logic_error("ThreadPool::configureGlobal: o pool global já foi criado.");
+    }
+    global_config = std::make_pair(num_threads, pin_threads);
+}
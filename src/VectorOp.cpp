@@ -5,21 +5,21 @@
 #include <stdexcept> // Para std::invalid_argument
 
 // Função que realiza a transposição de uma matriz (troca linhas por colunas)
-std::vector<std::vector<double>> VectorMath::transpose(const std::vector<std::vector<double>>& matrix) {
+Tensor VectorMath::transpose(ConstTensorView matrix) {
     
     // CORREÇÃO: Verifica se a matriz está vazia para evitar erro de acesso
-    if (matrix.empty() || matrix[0].empty()) {
+    if (matrix.empty()) {
         return {};
     }
 
     // Inicializa a matriz transposta com dimensões trocadas (colunas viram linhas e vice-versa)
-    std::vector<std::vector<double>> result(matrix[0].size(), std::vector<double>(matrix.size()));
+    Tensor result(matrix.cols(), matrix.rows());
     
     // Itera sobre a matriz original e preenche a transposta
-    for (size_t i = 0; i < matrix.size(); ++i) {
-        for (size_t j = 0; j < matrix[i].size(); ++j) {
+    for (size_t i = 0; i < matrix.rows(); ++i) {
+        for (size_t j = 0; j < matrix.cols(); ++j) {
             // Transpõe o elemento (i, j) para (j, i)
-            result[j][i] = matrix[i][j]; 
+            result(j, i) = matrix(i, j); 
         }
     }
     
@@ -28,15 +28,15 @@ std::vector<std::vector<double>> VectorMath::transpose(const std::vector<std::ve
 }
 
 // Função que realiza a multiplicação de duas matrizes (a * b)
-std::vector<std::vector<double>> VectorMath::matmul(const std::vector<std::vector<double>>& a, const std::vector<std::vector<double>>& b) {
+Tensor VectorMath::matmul(ConstTensorView a, ConstTensorView b) {
     
     // CORREÇÃO: Verificações de robustez
-    if (a.empty() || a[0].empty() || b.empty() || b[0].empty()) {
+    if (a.empty() || b.empty()) {
         return {};
     }
 
-    size_t a_cols = a[0].size();
-    size_t b_rows = b.size();
+    size_t a_cols = a.cols();
+    size_t b_rows = b.rows();
 
     // CORREÇÃO: Valida se as dimensões são compatíveis para multiplicação
     if (a_cols != b_rows) {
@@ -44,16 +44,10 @@ std::vector<std::vector<double>> VectorMath::matmul(const std::vector<std::vecto
     }
 
     // Inicializa a matriz resultante com o número de linhas de 'a' e o número de colunas de 'b'
-    std::vector<std::vector<double>> result(a.size(), std::vector<double>(b[0].size(), 0.0));
+    Tensor result(a.rows(), b.cols(), 0.0);
     
-    // Realiza a multiplicação de matrizes
-    for (size_t i = 0; i < a.size(); ++i) {           // Itera sobre as linhas da matriz 'a'
-        for (size_t j = 0; j < b[0].size(); ++j) {    // Itera sobre as colunas da matriz 'b'
-            for (size_t k = 0; k < a_cols; ++k) {     // Itera sobre as colunas de 'a' (ou linhas de 'b')
-                result[i][j] += a[i][k] * b[k][j];    // Calcula o produto escalar entre a linha de 'a' e a coluna de 'b'
-            }
-        }
-    }
+    // Realiza a multiplicação de matrizes com o GEMM empacotado (ver Gemm.cpp)
+    gemm(a, b, result);
     
     // Retorna a matriz resultante da multiplicação
     return result;